@@ -10,29 +10,56 @@ module adam_axil_aes_tb;
     `ADAM_BHV_CFG_LOCALPARAMS;
     
     localparam MAX_TRANS = 10;
+
+    // Blocks of the input and output FIFOs
+    localparam FIFO_DEPTH = 8;
+
+    // Blocks of the throughput runs
+    localparam NO_BLOCKS = 64;
     
-    // AES Register addresses
-    localparam ADDR_NAME0    = 32'h00;
-    localparam ADDR_VERSION  = 32'h02;
-    localparam ADDR_CTRL     = 32'h08;
-    localparam ADDR_STATUS   = 32'h09;
-    localparam ADDR_CONFIG   = 32'h0a;
-    localparam ADDR_KEY0     = 32'h10;
-    localparam ADDR_KEY7     = 32'h17;
-    localparam ADDR_BLOCK0   = 32'h20;
-    localparam ADDR_BLOCK3   = 32'h23;
-    localparam ADDR_RESULT0  = 32'h30;
-    localparam ADDR_RESULT3  = 32'h33;
+    // AES Register addresses, KEY, BLOCK, RESULT, DIN and DOUT auto-increment
+    localparam ADDR_CTRL     = 32'h00;
+    localparam ADDR_STATUS   = 32'h04;
+    localparam ADDR_CONFIG   = 32'h08;
+    localparam ADDR_ER       = 32'h0C;
+    localparam ADDR_IER      = 32'h10;
+    localparam ADDR_KEY      = 32'h14;
+    localparam ADDR_BLOCK    = 32'h18;
+    localparam ADDR_RESULT   = 32'h1C;
+    localparam ADDR_DIN      = 32'h20;
+    localparam ADDR_DOUT     = 32'h24;
+    localparam ADDR_FSR      = 32'h28;
+    localparam ADDR_FCR      = 32'h2C;
+    localparam ADDR_FIER     = 32'h30;
 
     // AES Test vectors
     localparam [255:0] AES128_KEY = 256'h2b7e151628aed2a6abf7158809cf4f3c00000000000000000000000000000000;
     localparam [127:0] PLAINTEXT = 128'h6bc1bee22e409f96e93d7e117393172a;
     localparam [127:0] EXPECTED_CIPHER = 128'h3ad77bb40d7a3660a89ecaf32466ef97;
 
+    // NIST SP 800-38A F.1.1, block i of a run is vector i % 4
+    localparam [127:0] ECB_PLAIN [4] = '{
+        128'h6bc1bee22e409f96e93d7e117393172a,
+        128'hae2d8a571e03ac9c9eb76fac45af8e51,
+        128'h30c81c46a35ce411e5fbc1191a0a52ef,
+        128'hf69f2445df4f9b17ad2b417be66c3710
+    };
+    localparam [127:0] ECB_CIPHER [4] = '{
+        128'h3ad77bb40d7a3660a89ecaf32466ef97,
+        128'hf5d3d58503b9699de785895a96fdbaaf,
+        128'h43b1cd7f598ece23881b00e3ed030688,
+        128'h7b0c785e27e8ad3f8223207104725dd4
+    };
+
     // Test infrastructure
     integer test_count = 0;
     integer error_count = 0;
 
+    // Clock cycles since the start
+    longint unsigned cycle = 0;
+
+    logic irq;
+
     //----------------------------------------------------------------
     // Framework instantiation 
     //----------------------------------------------------------------
@@ -58,13 +85,17 @@ module adam_axil_aes_tb;
     // DUT instantiation
     //----------------------------------------------------------------
     adam_axil_aes #(
-        `ADAM_CFG_PARAMS_MAP
+        `ADAM_CFG_PARAMS_MAP,
+        .FIFO_DEPTH (FIFO_DEPTH)
     ) dut (
         .seq(seq),
         .pause(pause),        
-        .axil(axil.Slave)     
+        .axil(axil.Slave),
+        .irq(irq)
     );
 
+    always @(posedge seq.clk) cycle++;
+
     //----------------------------------------------------------------
     // Master BHV initialization
     //----------------------------------------------------------------
@@ -142,7 +173,6 @@ module adam_axil_aes_tb;
 
     // Task complète pour test AES avec BHV
     task test_aes_encryption_bhv();
-        automatic DATA_T temp_data;
         automatic logic [127:0] result;
         begin
             $display("\n=== AES-128 Encryption Test with Uniform Framework ===");
@@ -151,40 +181,23 @@ module adam_axil_aes_tb;
             poll_status_bhv(0, 1); // STATUS_READY_BIT = 0
             
             // 2. Write key (8 words) using BHV
-            axi_write_bhv(ADDR_KEY0 + 0, AES128_KEY[255:224]);
-            axi_write_bhv(ADDR_KEY0 + 1, AES128_KEY[223:192]);
-            axi_write_bhv(ADDR_KEY0 + 2, AES128_KEY[191:160]);
-            axi_write_bhv(ADDR_KEY0 + 3, AES128_KEY[159:128]);
-            axi_write_bhv(ADDR_KEY0 + 4, AES128_KEY[127:96]);
-            axi_write_bhv(ADDR_KEY0 + 5, AES128_KEY[95:64]);
-            axi_write_bhv(ADDR_KEY0 + 6, AES128_KEY[63:32]);
-            axi_write_bhv(ADDR_KEY0 + 7, AES128_KEY[31:0]);
+            write_key_bhv();
             
             // 3. Write plaintext block using BHV
-            axi_write_bhv(ADDR_BLOCK0 + 0, PLAINTEXT[127:96]);
-            axi_write_bhv(ADDR_BLOCK0 + 1, PLAINTEXT[95:64]);
-            axi_write_bhv(ADDR_BLOCK0 + 2, PLAINTEXT[63:32]);
-            axi_write_bhv(ADDR_BLOCK0 + 3, PLAINTEXT[31:0]);
+            write_block_bhv(ADDR_BLOCK, PLAINTEXT);
             
             // 4. Configure: AES-128, Encrypt
             axi_write_bhv(ADDR_CONFIG, 32'h01); // encdec=1, keylen=0
             
             // 5. Start operation
             $display("[%0t] Starting AES encryption...", $time);
-            axi_write_bhv(ADDR_CTRL, 32'h01);
+            axi_write_bhv(ADDR_CTRL, 32'h03); // start=1, enable=1
             
             // 6. Poll for completion
             poll_status_bhv(1, 1); // STATUS_VALID_BIT = 1
             
             // 7. Read result using BHV
-            axi_read_bhv(ADDR_RESULT0 + 0, temp_data);
-            result[127:96] = temp_data;
-            axi_read_bhv(ADDR_RESULT0 + 1, temp_data);
-            result[95:64] = temp_data;
-            axi_read_bhv(ADDR_RESULT0 + 2, temp_data);
-            result[63:32] = temp_data;
-            axi_read_bhv(ADDR_RESULT0 + 3, temp_data);
-            result[31:0] = temp_data;
+            read_block_bhv(ADDR_RESULT, result);
             
             // 8. Verify result
             if (result == EXPECTED_CIPHER) begin
@@ -205,21 +218,231 @@ module adam_axil_aes_tb;
         begin
             $display("\n=== Testing Basic Registers with Uniform Framework ===");
             
-            // Test reading ID registers
-            axi_read_bhv(ADDR_NAME0, data);
-            if (data != 32'h61657320) begin // "aes "
-                $display("ERROR: NAME0 register mismatch");
+            // Peripheral disabled after reset
+            axi_read_bhv(ADDR_CTRL, data);
+            if (data != 32'h0) begin
+                $display("ERROR: CTRL reset value 0x%08x", data);
                 error_count++;
             end else begin
-                $display("SUCCESS: NAME0 register = 0x%08x", data);
+                $display("SUCCESS: CTRL register = 0x%08x", data);
             end
             
-            axi_read_bhv(ADDR_VERSION, data);
-            $display("Version register: 0x%08x", data);
-            
             // Test status register
             axi_read_bhv(ADDR_STATUS, data);
             $display("Initial status: 0x%08x", data);
+
+            // Empty FIFOs, the input one at its watermark
+            axi_read_bhv(ADDR_FSR, data);
+            if (data != 32'h1) begin
+                $display("ERROR: FSR reset value 0x%08x", data);
+                error_count++;
+            end else begin
+                $display("SUCCESS: FSR register = 0x%08x", data);
+            end
+        end
+    endtask
+
+    //----------------------------------------------------------------
+    // Blocks and throughput
+    //----------------------------------------------------------------
+
+    task write_key_bhv();
+        for (int i = 0; i < 8; i++) begin
+            axi_write_bhv(ADDR_KEY, AES128_KEY[255 - 32*i -: 32]);
+        end
+    endtask
+
+    // Four writes to BLOCK or DIN, most significant word first
+    task write_block_bhv(input ADDR_T addr, input logic [127:0] block);
+        for (int i = 0; i < 4; i++) begin
+            axi_write_bhv(addr, block[127 - 32*i -: 32]);
+        end
+    endtask
+
+    // Four reads of RESULT or DOUT
+    task read_block_bhv(input ADDR_T addr, output logic [127:0] block);
+        automatic DATA_T data;
+        for (int i = 0; i < 4; i++) begin
+            axi_read_bhv(addr, data);
+            block[127 - 32*i -: 32] = data;
+        end
+    endtask
+
+    task check_block(
+        input string        run,
+        input integer       index,
+        input logic [127:0] block
+    );
+        if (block != ECB_CIPHER[index % 4]) begin
+            $display("ERROR: %s block %0d is 0x%032x, expected 0x%032x",
+                run, index, block, ECB_CIPHER[index % 4]);
+            error_count++;
+        end
+    endtask
+
+    // One CSV line per run: aes_tp,<run>,<blocks>,<cycles>,<blocks per cycle>
+    task report(input string run, input integer blocks, input longint cycles);
+        $display("aes_tp,%s,%0d,%0d,%0.4f", run, blocks, cycles,
+            real'(blocks) / real'(cycles));
+    endtask
+
+    task wait_irq();
+        while (!irq) begin
+            @(posedge seq.clk);
+            #TT;
+        end
+    endtask
+
+    // Baseline, one block at a time through BLOCK, START and RESULT
+    task test_single_bhv(output longint cycles);
+        automatic logic [127:0] result;
+        automatic DATA_T        data;
+        automatic longint       t0;
+        begin
+            $display("\n=== Single Block Throughput ===");
+
+            t0 = cycle;
+            for (int i = 0; i < NO_BLOCKS; i++) begin
+                write_block_bhv(ADDR_BLOCK, ECB_PLAIN[i % 4]);
+                axi_write_bhv(ADDR_ER, 32'h01);
+                axi_write_bhv(ADDR_CTRL, 32'h03);
+                do axi_read_bhv(ADDR_ER, data); while (!data[0]);
+                read_block_bhv(ADDR_RESULT, result);
+                check_block("single", i, result);
+            end
+            cycles = cycle - t0;
+
+            report("single", NO_BLOCKS, cycles);
+        end
+    endtask
+
+    // FIFO_DEPTH blocks queued with the peripheral disabled, then released
+    // at once: the core latency and its rate of one block per cycle
+    task test_burst_bhv();
+        automatic logic [127:0] result;
+        automatic DATA_T        data;
+        automatic longint       t0;
+        begin
+            $display("\n=== FIFO Burst ===");
+
+            axi_write_bhv(ADDR_CTRL, 32'h00);
+            for (int i = 0; i < FIFO_DEPTH; i++) begin
+                write_block_bhv(ADDR_DIN, ECB_PLAIN[i % 4]);
+            end
+
+            t0 = cycle;
+            axi_write_bhv(ADDR_CTRL, 32'h02);
+            do axi_read_bhv(ADDR_FSR, data); while (data[23:16] != FIFO_DEPTH);
+            report("burst", FIFO_DEPTH, cycle - t0);
+
+            for (int i = 0; i < FIFO_DEPTH; i++) begin
+                read_block_bhv(ADDR_DOUT, result);
+                check_block("burst", i, result);
+            end
+        end
+    endtask
+
+    // Sustained rate, a writer keeps DIN fed while a reader drains DOUT on
+    // the output watermark interrupt. The writer stays at most two FIFOs
+    // ahead, the input one and the output one the core reserves.
+    task test_stream_bhv(input longint single_cycles);
+        automatic integer written = 0;
+        automatic integer drained = 0;
+        automatic longint t0;
+        automatic longint cycles;
+        automatic DATA_T  data;
+        begin
+            $display("\n=== FIFO Stream Throughput ===");
+
+            axi_write_bhv(ADDR_FCR, 32'h0000_0100); // OWML = 1
+            axi_write_bhv(ADDR_FIER, 32'h02);       // OWMIE
+
+            t0 = cycle;
+            fork
+                while (written < NO_BLOCKS) begin
+                    if (written - drained < 2*FIFO_DEPTH) begin
+                        write_block_bhv(ADDR_DIN, ECB_PLAIN[written % 4]);
+                        written++;
+                    end else begin
+                        @(posedge seq.clk);
+                    end
+                end
+
+                while (drained < NO_BLOCKS) begin
+                    automatic logic [127:0] result;
+                    wait_irq();
+                    read_block_bhv(ADDR_DOUT, result);
+                    check_block("stream", drained, result);
+                    drained++;
+
+                    // The level drops on the last read
+                    @(posedge seq.clk);
+                    #TT;
+                end
+            join
+            cycles = cycle - t0;
+
+            report("stream", NO_BLOCKS, cycles);
+            $display("Speedup over single blocks: %0.2f",
+                real'(single_cycles) / real'(cycles));
+
+            axi_write_bhv(ADDR_FIER, 32'h00);
+
+            // No block dropped, no empty read
+            axi_read_bhv(ADDR_FSR, data);
+            if (data[3:2] != 2'b00 || data[23:8] != 16'h0000) begin
+                $display("ERROR: FSR after the stream 0x%08x", data);
+                error_count++;
+            end
+        end
+    endtask
+
+    // FLUSH empties both FIFOs, blocks still in the core included
+    task test_flush_bhv();
+        automatic DATA_T data;
+        automatic logic [127:0] result;
+        begin
+            $display("\n=== FIFO Flush ===");
+
+            for (int i = 0; i < 3; i++) begin
+                write_block_bhv(ADDR_DIN, ECB_PLAIN[i % 4]);
+            end
+            axi_write_bhv(ADDR_FCR, 32'h0001_0000);
+            repeat (20) @(posedge seq.clk);
+
+            axi_read_bhv(ADDR_FSR, data);
+            if (data[23:8] != 16'h0000) begin
+                $display("ERROR: FSR after a flush 0x%08x", data);
+                error_count++;
+            end
+
+            // The next block is the first one out
+            write_block_bhv(ADDR_DIN, ECB_PLAIN[0]);
+            do axi_read_bhv(ADDR_FSR, data); while (data[23:16] == 0);
+            read_block_bhv(ADDR_DOUT, result);
+            check_block("flush", 0, result);
+
+            // Reading an empty FIFO sets OUD, write 1 to clear
+            axi_read_bhv(ADDR_DOUT, data);
+            axi_read_bhv(ADDR_FSR, data);
+            if (!data[3]) begin
+                $display("ERROR: no underrun flag, FSR 0x%08x", data);
+                error_count++;
+            end
+            axi_write_bhv(ADDR_FSR, 32'h08);
+        end
+    endtask
+
+    task test_summary();
+        repeat (10) @(posedge seq.clk);
+        $display("\n=== Test Summary ===");
+        $display("Tests run: %0d", test_count);
+        $display("Errors: %0d", error_count);
+        
+        if (error_count == 0) begin
+            $display("*** ALL TESTS PASSED ***");
+        end else begin
+            $display("*** %0d TESTS FAILED ***", error_count);
         end
     endtask
 
@@ -239,16 +462,29 @@ module adam_axil_aes_tb;
             test_aes_encryption_bhv();
             
             // Final report
+            test_summary();
+            assert (error_count == 0);
+        end
+
+        `TEST_CASE("fifo") begin
+            automatic longint single_cycles;
+
+            $display("=== AXI4-Lite AES FIFO Throughput ===");
+
+            @(negedge seq.rst);
             repeat (10) @(posedge seq.clk);
-            $display("\n=== Test Summary ===");
-            $display("Tests run: %0d", test_count);
-            $display("Errors: %0d", error_count);
-            
-            if (error_count == 0) begin
-                $display("*** ALL TESTS PASSED ***");
-            end else begin
-                $display("*** %0d TESTS FAILED ***", error_count);
-            end
+
+            write_key_bhv();
+            axi_write_bhv(ADDR_CONFIG, 32'h01);
+            axi_write_bhv(ADDR_CTRL, 32'h02);
+
+            test_single_bhv(single_cycles);
+            test_burst_bhv();
+            test_stream_bhv(single_cycles);
+            test_flush_bhv();
+
+            test_summary();
+            assert (error_count == 0);
         end
     end
 
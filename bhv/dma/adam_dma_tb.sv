@@ -0,0 +1,277 @@
+`timescale 1ns/1ps
+`include "adam/macros_bhv.svh"
+`include "axi/assign.svh"
+`include "vunit_defines.svh"
+
+module adam_dma_tb;
+    import adam_axil_slv_bhv::*;
+
+    `ADAM_BHV_CFG_LOCALPARAMS;
+
+    localparam MAX_TRANS = 4;
+    localparam NO_WORDS  = 16;
+
+    // memory map of the slave model
+    localparam ADDR_T DESC_A = 32'h0000_0100;
+    localparam ADDR_T DESC_B = 32'h0000_0200;
+    localparam ADDR_T SRC    = 32'h0000_1000;
+    localparam ADDR_T DST    = 32'h0000_2000;
+    localparam ADDR_T FIFO   = 32'h1000_0000;
+    localparam ADDR_T NO_MEM = 32'h2000_0000; // reads and writes fail
+
+    localparam CTRL_SINC  = 32'h0000_0001;
+    localparam CTRL_DINC  = 32'h0000_0002;
+    localparam CTRL_PACED = 32'h0000_0004;
+    localparam CTRL_ERR   = 32'h4000_0000;
+    localparam CTRL_DONE  = 32'h8000_0000;
+
+    // seq and pause ==========================================================
+
+    ADAM_SEQ   seq   ();
+    ADAM_PAUSE pause ();
+
+    adam_seq_bhv #(
+        `ADAM_BHV_CFG_PARAMS_MAP
+    ) adam_seq_bhv (
+        .seq (seq)
+    );
+
+    // memory =================================================================
+
+    `ADAM_AXIL_I axil ();
+    `ADAM_AXIL_DV_I axil_dv (seq.clk);
+
+    adam_axil_slv_bhv #(
+        `ADAM_BHV_CFG_PARAMS_MAP,
+
+        .MAX_TRANS (MAX_TRANS)
+    ) axil_bhv;
+
+    `AXI_LITE_ASSIGN(axil_dv, axil);
+
+    DATA_T mem [ADDR_T];
+
+    // FIFO mapped at FIFO, reads fail while it is empty
+    DATA_T fifo [$];
+
+    initial begin
+        axil_bhv = new(axil_dv);
+        axil_bhv.loop();
+    end
+
+    initial begin
+        ADDR_T addr;
+        PROT_T prot;
+        DATA_T data;
+        STRB_T strb;
+
+        @(negedge seq.rst);
+        @(posedge seq.clk);
+
+        forever begin
+            fork
+                axil_bhv.recv_aw(addr, prot);
+                axil_bhv.recv_w(data, strb);
+            join
+            assert (strb == '1);
+            if (addr >= NO_MEM) begin
+                axil_bhv.send_b(axi_pkg::RESP_DECERR);
+            end
+            else begin
+                mem[addr] = data;
+                axil_bhv.send_b(axi_pkg::RESP_OKAY);
+            end
+        end
+    end
+
+    initial begin
+        ADDR_T addr;
+        PROT_T prot;
+
+        @(negedge seq.rst);
+        @(posedge seq.clk);
+
+        forever begin
+            axil_bhv.recv_ar(addr, prot);
+            if (addr == FIFO) begin
+                if (fifo.size() > 0) begin
+                    axil_bhv.send_r(fifo.pop_back(), axi_pkg::RESP_OKAY);
+                end
+                else begin
+                    axil_bhv.send_r('0, axi_pkg::RESP_SLVERR);
+                end
+            end
+            else if (mem.exists(addr)) begin
+                axil_bhv.send_r(mem[addr], axi_pkg::RESP_OKAY);
+            end
+            else begin
+                axil_bhv.send_r('0, axi_pkg::RESP_DECERR);
+            end
+        end
+    end
+
+    // dut ====================================================================
+
+    ADDR_T desc_addr;
+    logic  req;
+    logic  irq;
+
+    adam_dma #(
+        `ADAM_CFG_PARAMS_MAP
+    ) dut (
+        .seq   (seq),
+        .pause (pause),
+
+        .desc_addr (desc_addr),
+        .req       (req),
+        .irq       (irq),
+
+        .axil (axil)
+    );
+
+    // test ===================================================================
+
+    `TEST_SUITE begin
+        `TEST_SETUP begin
+            desc_addr = DESC_A;
+            req       = 0;
+            pause.req = 1;
+
+            for (int i = 0; i < NO_WORDS; i++) begin
+                mem[SRC + 4*i] = $urandom();
+            end
+
+            `ADAM_UNTIL(!seq.rst);
+        end
+
+        `TEST_CASE("copy") begin
+            write_desc(DESC_A, SRC, DST, NO_WORDS, CTRL_SINC | CTRL_DINC, 0);
+            run();
+
+            assert (mem[DESC_A + 12] == (CTRL_DONE | CTRL_SINC | CTRL_DINC));
+            for (int i = 0; i < NO_WORDS; i++) begin
+                assert (mem[DST + 4*i] == mem[SRC + 4*i]);
+            end
+        end
+
+        `TEST_CASE("chain") begin
+            write_desc(DESC_A, SRC, DST, NO_WORDS/2,
+                CTRL_SINC | CTRL_DINC, DESC_B);
+            write_desc(DESC_B, SRC + 2*NO_WORDS, DST + 2*NO_WORDS,
+                NO_WORDS/2, CTRL_SINC | CTRL_DINC, 0);
+            run();
+
+            assert (mem[DESC_A + 12] & CTRL_DONE);
+            assert (mem[DESC_B + 12] & CTRL_DONE);
+            for (int i = 0; i < NO_WORDS; i++) begin
+                assert (mem[DST + 4*i] == mem[SRC + 4*i]);
+            end
+        end
+
+        `TEST_CASE("paced") begin
+            write_desc(DESC_A, FIFO, DST, NO_WORDS,
+                CTRL_DINC | CTRL_PACED, 0);
+
+            fork
+                run();
+                for (int i = 0; i < NO_WORDS; i++) begin
+                    repeat ($urandom_range(0, 20)) @(posedge seq.clk);
+                    fifo.push_front(mem[SRC + 4*i]);
+                end
+            join
+
+            assert (mem[DESC_A + 12] == (CTRL_DONE | CTRL_DINC | CTRL_PACED));
+            for (int i = 0; i < NO_WORDS; i++) begin
+                assert (mem[DST + 4*i] == mem[SRC + 4*i]);
+            end
+        end
+
+        `TEST_CASE("error") begin
+            write_desc(DESC_A, 32'h0000_8000, DST, NO_WORDS,
+                CTRL_SINC | CTRL_DINC, DESC_B);
+            write_desc(DESC_B, SRC, DST, NO_WORDS, CTRL_SINC | CTRL_DINC, 0);
+            run();
+
+            // the chain stops on the failed descriptor
+            assert (mem[DESC_A + 12] & CTRL_ERR);
+            assert (!(mem[DESC_B + 12] & CTRL_DONE));
+            assert (!mem.exists(DST));
+        end
+
+        `TEST_CASE("desc_unreadable") begin
+            // nothing at DESC_A, the write-back still flags it
+            run();
+
+            assert (mem[DESC_A + 12] == (CTRL_DONE | CTRL_ERR));
+            assert (!mem.exists(DST));
+        end
+
+        `TEST_CASE("desc_next_unreadable") begin
+            write_desc(DESC_A, SRC, DST, NO_WORDS, CTRL_SINC | CTRL_DINC, 0);
+            mem.delete(DESC_A + 16);
+            run();
+
+            assert (mem[DESC_A + 12] ==
+                (CTRL_DONE | CTRL_ERR | CTRL_SINC | CTRL_DINC));
+            assert (!mem.exists(DST));
+        end
+
+        `TEST_CASE("desc_unmapped") begin
+            // the write-back fails too, the chain still ends with irq
+            desc_addr = NO_MEM;
+            run();
+
+            assert (irq);
+            assert (!mem.exists(DST));
+        end
+    end
+
+    initial begin
+        #10000us $error("timeout");
+    end
+
+    task write_desc(
+        input ADDR_T desc,
+        input ADDR_T src,
+        input ADDR_T dst,
+        input DATA_T count,
+        input DATA_T ctrl,
+        input ADDR_T next
+    );
+        mem[desc +  0] = src;
+        mem[desc +  4] = dst;
+        mem[desc +  8] = count;
+        mem[desc + 12] = ctrl;
+        mem[desc + 16] = next;
+    endtask
+
+    task run();
+        // req is high while the FIFO has data, with spurious requests to
+        // exercise the retry on an empty FIFO
+        fork
+            forever begin
+                @(posedge seq.clk);
+                req <= (fifo.size() > 0) || ($urandom_range(0, 3) == 0);
+            end
+        join_none
+
+        pause.req <= 0;
+        `ADAM_UNTIL(pause.ack == 0);
+        `ADAM_UNTIL(irq);
+
+        // pause in DONE, as the maestro does before a stop
+        pause.req <= 1;
+        `ADAM_UNTIL(pause.ack);
+
+        disable fork;
+    endtask
+
+    task cycle_start();
+        #TT;
+    endtask
+
+    task cycle_end();
+        @(posedge seq.clk);
+    endtask
+
+endmodule
@@ -92,7 +92,12 @@ module adam_aes_tb();
            .we(tb_we),
            .address(tb_address),
            .write_data(tb_write_data),
-           .read_data(tb_read_data)
+           .read_data(tb_read_data),
+           .stream_valid(1'b0),
+           .stream_ready(),
+           .stream_block(128'h0),
+           .stream_result_valid(),
+           .stream_result()
           );
 
   //----------------------------------------------------------------
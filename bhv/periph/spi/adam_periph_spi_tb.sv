@@ -11,10 +11,15 @@ module adam_periph_spi_tb;
     localparam NO_TESTS  = 100;
     localparam BAUD_RATE = 1000000;
 
+    localparam RX_FIFO_DEPTH = 16;
+    localparam NO_TRIGGERS   = 8;
+    localparam WATERMARK     = 4;
+
     ADAM_SEQ   seq   ();
     ADAM_PAUSE pause ();
 
     logic irq;
+    logic trigger;
     
     ADAM_IO sclk();
     ADAM_IO mosi();
@@ -53,7 +58,9 @@ module adam_periph_spi_tb;
     ) master = new(slv_dv);
 
     adam_periph_spi #(
-        `ADAM_CFG_PARAMS_MAP
+        `ADAM_CFG_PARAMS_MAP,
+
+        .RX_FIFO_DEPTH (RX_FIFO_DEPTH)
     ) dut (
         .seq   (seq),
         .pause (pause),
@@ -62,6 +69,8 @@ module adam_periph_spi_tb;
         
         .irq (irq),
 
+        .trigger (trigger),
+
         .sclk (sclk),
         .mosi (mosi),
         .miso (miso),
@@ -88,6 +97,7 @@ module adam_periph_spi_tb;
             strb = 4'b1111;
 
             critical = 0;
+            trigger  = 0;
             
             @(negedge seq.rst);
             master.reset_master();
@@ -192,6 +202,122 @@ module adam_periph_spi_tb;
             
             repeat (10) @(posedge seq.clk);
         end
+
+        `TEST_CASE("fifo") begin
+            automatic ADDR_T addr;
+            automatic DATA_T data;
+            automatic STRB_T strb;
+            automatic logic  resp;
+            
+            automatic DATA_T check;
+            automatic int    received;
+
+            strb = 4'b1111;
+
+            critical = 0;
+            trigger  = 0;
+            
+            @(negedge seq.rst);
+            master.reset_master();
+            repeat (10) @(posedge seq.clk);
+
+            critical_begin();
+
+            // Write to Baud Rate Register (BRR)
+            addr = 32'h000C;
+            data = 50e6 / BAUD_RATE;
+            master.write(addr, data, strb, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+
+            // Write to Control Register (CR)
+            // All enabled, master, leading edge, low polarity, lsb, 8 bit frame 
+            addr = 32'h0004; 
+            data = 32'h0000_080F; 
+            master.write(addr, data, strb, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+
+            // Write to FIFO Control Register (FCR)
+            // Watermark, timer trigger enabled
+            addr = 32'h0014;
+            data = 32'h0000_0100 | WATERMARK;
+            master.write(addr, data, strb, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+
+            // Verify FCR value
+            master.read(addr, check, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+            assert (check == data);
+
+            // Write to Interrupt Enable Register (IER)
+            // RX FIFO Watermark Interrupt Enable only
+            addr = 32'h0010;
+            data = 32'h0000_0004;
+            master.write(addr, data, strb, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+            assert (irq == 0);
+
+            // The first word is written by software, the triggers resend it
+            addr = 32'h0000; // Data Register (DR)
+            data = 32'h0000_00A5;
+            master.write(addr, data, strb, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+
+            repeat (NO_TRIGGERS - 1) begin
+                #20us;
+                trigger_pulse();
+            end
+            #20us;
+
+            // Watermark reached, no trigger dropped
+            assert (irq == 1);
+            addr = 32'h0008; // Status Register (SR)
+            master.read(addr, data, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+            assert (data[2] == 1); // RX FIFO Watermark (RWM)
+            assert (data[3] == 0); // RX Overrun (ROV)
+            assert (data[15:8] == NO_TRIGGERS); // RX FIFO Level (RXL)
+
+            // Drain the FIFO
+            received = 0;
+            do begin
+                addr = 32'h0000; // Data Register (DR)
+                master.read(addr, check, resp);
+                assert (resp == apb_pkg::RESP_OKAY);
+                assert (check == 32'h0000_00A5);
+                received++;
+
+                addr = 32'h0008; // Status Register (SR)
+                master.read(addr, data, resp);
+                assert (resp == apb_pkg::RESP_OKAY);
+            end while (data[1] == 1); // Receive Buffer Full (RBF)
+
+            assert (received == NO_TRIGGERS);
+            assert (irq == 0);
+
+            // Triggers on a full FIFO are dropped and flagged
+            repeat (RX_FIFO_DEPTH + 2) begin
+                trigger_pulse();
+                #20us;
+            end
+
+            addr = 32'h0008; // Status Register (SR)
+            master.read(addr, data, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+            assert (data[3] == 1); // RX Overrun (ROV)
+            assert (data[15:8] == RX_FIFO_DEPTH);
+
+            // ROV is write 1 to clear
+            data = 32'h0000_0008;
+            master.write(addr, data, strb, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+            master.read(addr, data, resp);
+            assert (resp == apb_pkg::RESP_OKAY);
+            assert (data[3] == 0);
+
+            critical_end();
+
+            repeat (10) @(posedge seq.clk);
+        end
     end
 
     initial begin
@@ -211,6 +337,15 @@ module adam_periph_spi_tb;
         cycle_end();
     endtask;
 
+    task trigger_pulse();
+        trigger <= #TA 1;
+        cycle_start();
+        cycle_end();
+        trigger <= #TA 0;
+        cycle_start();
+        cycle_end();
+    endtask
+
     task critical_end();
         critical <= #TA 0;
         cycle_start();
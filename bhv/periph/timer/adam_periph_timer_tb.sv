@@ -15,6 +15,9 @@ module adam_periph_timer_tb;
     ADAM_PAUSE pause ();
     
     logic irq;
+    logic trigger;
+
+    int triggers;
 
     ADAM_PAUSE pause_auto ();
     logic      critical;
@@ -56,9 +59,16 @@ module adam_periph_timer_tb;
 
         .slv (slave),
         
-        .irq (irq)
+        .irq (irq),
+
+        .trigger (trigger)
     );
 
+    // Count the auto reload pulses
+    always @(posedge seq.clk) begin
+        if (trigger) triggers <= triggers + 1;
+    end
+
     always_comb begin
         pause.req = pause_auto.req && !critical;
         pause_auto.ack = pause.ack;
@@ -166,6 +176,8 @@ module adam_periph_timer_tb;
                 assert (resp == apb_pkg::RESP_OKAY);
                 assert (check == data);
 
+                triggers = 0;
+
                 fork
                     repeat (no_events) begin
                         @(posedge irq);
@@ -183,6 +195,9 @@ module adam_periph_timer_tb;
                     end
                 join
 
+                // One trigger pulse per auto reload event
+                assert (triggers >= no_events);
+
                 critical_end();
             end
         end
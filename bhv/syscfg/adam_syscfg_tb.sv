@@ -73,7 +73,9 @@ module adam_syscfg_tb;
 
     logic      dma_rst       [NO_DMAS+1];
     ADAM_PAUSE dma_pause     [NO_DMAS+1] ();
+    ADDR_T     dma_boot_addr [NO_DMAS+1];
     logic      dma_irq       [NO_DMAS+1];
+    logic      dma_done      [NO_DMAS+1];
 
     logic      mem_rst   [NO_MEMS+1];
     ADAM_PAUSE mem_pause [NO_MEMS+1] ();
@@ -129,9 +131,11 @@ module adam_syscfg_tb;
         .cpu_boot_addr (cpu_boot_addr),
         .cpu_irq       (cpu_irq),
 
-        .dma_rst   (dma_rst),
-        .dma_pause (dma_pause),
-        .dma_irq   (dma_irq),
+        .dma_rst       (dma_rst),
+        .dma_pause     (dma_pause),
+        .dma_boot_addr (dma_boot_addr),
+        .dma_irq       (dma_irq),
+        .dma_done      (dma_done),
 
         .mem_rst   (mem_rst),
         .mem_pause (mem_pause),
@@ -165,6 +169,7 @@ module adam_syscfg_tb;
         end
         for (genvar i = 0; i < NO_DMAS; i++) begin
             assign dma_pause[i].ack = dma_pause[i].req;
+            assign dma_done[i] = 0;
         end
         for (genvar i = 0; i < NO_MEMS; i++) begin
             assign mem_pause[i].ack = mem_pause[i].req;
@@ -96,10 +96,13 @@ module adam #(
         `ADAM_AXIL_I hsdom_cpu_axil [2*NO_CPUS+1] ();
     `endif
 
-    logic        hsdom_dma_rst   [NO_DMAS+1];
-    ADAM_PAUSE   hsdom_dma_pause [NO_DMAS+1] ();
-    `ADAM_AXIL_I hsdom_dma_axil  [NO_DMAS+1] ();
-    logic        hsdom_dma_irq   [NO_DMAS+1];
+    ADAM_SEQ     hsdom_dma_seq       [NO_DMAS+1] ();
+    logic        hsdom_dma_rst       [NO_DMAS+1];
+    ADAM_PAUSE   hsdom_dma_pause     [NO_DMAS+1] ();
+    ADDR_T       hsdom_dma_desc_addr [NO_DMAS+1];
+    `ADAM_AXIL_I hsdom_dma_axil      [NO_DMAS+1] ();
+    logic        hsdom_dma_irq       [NO_DMAS+1];
+    logic        hsdom_dma_done      [NO_DMAS+1];
 
     logic        hsdom_hsp_rst   [NO_HSPS+1];
     ADAM_PAUSE   hsdom_hsp_pause [NO_HSPS+1] ();
@@ -353,8 +356,21 @@ module adam #(
     // hsdom - dma ============================================================
 
     for (genvar i = 0; i < NO_DMAS; i++) begin
-        `ADAM_PAUSE_SLV_TIE_OFF(hsdom_dma_pause[i]);
-        `ADAM_AXIL_MST_TIE_OFF (hsdom_dma_axil [i]);
+        assign hsdom_dma_seq[i].clk = hsdom_seq.clk;
+        assign hsdom_dma_seq[i].rst = hsdom_seq.rst || hsdom_dma_rst[i];
+
+        adam_dma #(
+            `ADAM_CFG_PARAMS_MAP
+        ) hsdom_dma (
+            .seq   (hsdom_dma_seq[i]),
+            .pause (hsdom_dma_pause[i]),
+
+            .desc_addr (hsdom_dma_desc_addr[i]),
+            .req       (hsdom_dma_irq[i]),
+            .irq       (hsdom_dma_done[i]),
+
+            .axil (hsdom_dma_axil[i])
+        );
     end
 
     // hsdom - mem ============================================================
@@ -612,9 +628,11 @@ end
         .cpu_boot_addr (hsdom_cpu_boot_addr),
         .cpu_irq       (hsdom_cpu_irq),
 
-        .dma_rst   (hsdom_dma_rst),
-        .dma_pause (hsdom_dma_pause),
-        .dma_irq   (hsdom_dma_irq),
+        .dma_rst       (hsdom_dma_rst),
+        .dma_pause     (hsdom_dma_pause),
+        .dma_boot_addr (hsdom_dma_desc_addr),
+        .dma_irq       (hsdom_dma_irq),
+        .dma_done      (hsdom_dma_done),
 
         .mem_rst   (hsdom_mem_rst),
         .mem_pause (hsdom_mem_pause),
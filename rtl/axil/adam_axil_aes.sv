@@ -9,7 +9,15 @@
 module adam_axil_aes #(
     `ADAM_CFG_PARAMS,
     
-    parameter MAX_TRANS = FAB_MAX_TRANS
+    parameter MAX_TRANS = FAB_MAX_TRANS,
+
+    // Blocks of the input and output FIFOs, power of two, at most 128
+    parameter FIFO_DEPTH = 8,
+
+    // Dependent parameters, DO NOT OVERRIDE!
+
+    parameter FIFO_PTR_WIDTH   = $clog2(FIFO_DEPTH),
+    parameter FIFO_LEVEL_WIDTH = $clog2(FIFO_DEPTH+1)
 ) (
     ADAM_SEQ.Slave   seq,
     ADAM_PAUSE.Slave pause,
@@ -44,6 +52,15 @@ module adam_axil_aes #(
     `AXI_LITE_ASSIGN_TO_AR(ar_chan, axil);
     `AXI_LITE_ASSIGN_FROM_R(axil, r_chan);
 
+    //----------------------------------------------------------------
+    // Block FIFO registers, after those of the core
+    //----------------------------------------------------------------
+    localparam ADDR_DIN  = 8'h20; // Input FIFO, a block every 4 writes
+    localparam ADDR_DOUT = 8'h24; // Output FIFO, a block every 4 reads
+    localparam ADDR_FSR  = 8'h28; // FIFO Status Register
+    localparam ADDR_FCR  = 8'h2C; // FIFO Control Register
+    localparam ADDR_FIER = 8'h30; // FIFO Interrupt Enable Register
+
     //----------------------------------------------------------------
     // FSM States
     //----------------------------------------------------------------
@@ -85,7 +102,61 @@ module adam_axil_aes #(
     DATA_T write_data_internal;
     logic aes_irq;
 
-    assign irq = aes_irq;
+    // Block stream to the core
+    logic         stream_valid;
+    logic         stream_ready;
+    logic [127:0] stream_block;
+    logic         stream_result_valid;
+    logic [127:0] stream_result;
+
+    // Input FIFO, blocks written to DIN, words assembled in in_buf
+    logic [127:0]                in_fifo [FIFO_DEPTH];
+    logic [FIFO_PTR_WIDTH-1:0]   in_rptr;
+    logic [FIFO_PTR_WIDTH-1:0]   in_wptr;
+    logic [FIFO_LEVEL_WIDTH-1:0] in_level;
+    logic [95:0]                 in_buf;
+    logic [1:0]                  in_word;
+
+    // Output FIFO, results read from DOUT, word by word
+    logic [127:0]                out_fifo [FIFO_DEPTH];
+    logic [FIFO_PTR_WIDTH-1:0]   out_rptr;
+    logic [FIFO_PTR_WIDTH-1:0]   out_wptr;
+    logic [FIFO_LEVEL_WIDTH-1:0] out_level;
+    logic [1:0]                  out_word;
+
+    // Blocks in the core, each one has a slot reserved in the output FIFO.
+    // Those still in flight at a flush are discarded when they come out.
+    logic [FIFO_LEVEL_WIDTH-1:0] in_flight;
+    logic [FIFO_LEVEL_WIDTH-1:0] discard;
+
+    // Normal Registers
+    DATA_T fifo_status;
+    DATA_T fifo_control;
+    DATA_T fifo_interrupt_enable;
+
+    // FIFO Status Register (FSR)
+    logic in_watermark;  // Input FIFO at or below its watermark
+    logic out_watermark; // Output FIFO at or above its watermark
+    logic in_overrun;    // Block written to a full input FIFO, dropped
+    logic out_underrun;  // Read from an empty output FIFO
+
+    // FIFO Control Register (FCR)
+    logic [7:0] in_watermark_level;
+    logic [7:0] out_watermark_level;
+
+    // FIFO Interrupt Enable Register (FIER)
+    logic in_watermark_ie;
+    logic out_watermark_ie;
+    logic in_overrun_ie;
+    logic out_underrun_ie;
+
+    // Accesses to the FIFO registers, on the B and R handshakes
+    logic  fifo_write;
+    logic  fifo_read;
+    DATA_T fifo_read_data;
+    logic  fifo_irq;
+
+    assign irq = aes_irq || fifo_irq;
 
     //----------------------------------------------------------------
     // AES Core instantiation
@@ -98,6 +169,11 @@ module adam_axil_aes #(
         .address(aes_address),
         .write_data(aes_write_data),
         .read_data(aes_read_data),
+        .stream_valid(stream_valid),
+        .stream_ready(stream_ready),
+        .stream_block(stream_block),
+        .stream_result_valid(stream_result_valid),
+        .stream_result(stream_result),
         .irq(aes_irq)
     );
 
@@ -109,13 +185,19 @@ module adam_axil_aes #(
             8'h00, 8'h04, 8'h08,8'h0C,8'h10,
             8'h14,
             8'h18, 
-            8'h1C:   
+            8'h1C,
+            ADDR_DIN, ADDR_DOUT, ADDR_FSR, ADDR_FCR, ADDR_FIER:
                 return 1'b1;
             default:
                 return 1'b0;
         endcase
     endfunction
 
+    // Registers of the core, the others are the FIFO ones
+    function automatic logic addr_is_core(input ADDR_T addr);
+        return addr[7:0] < ADDR_DIN;
+    endfunction
+
     //----------------------------------------------------------------
     // Register update
     //----------------------------------------------------------------
@@ -164,6 +246,7 @@ module adam_axil_aes #(
         write_active = 1'b0;
         write_addr = 8'h00;
         write_data_internal = '0;
+        fifo_write = 1'b0;
         
         addr_valid = addr_is_valid(awaddr_reg);
         data_valid = (wstrb_reg == '1); // All bytes must be written
@@ -204,9 +287,13 @@ module adam_axil_aes #(
             W_RESP: begin
                 // Execute write to AES core
                 if (addr_valid && data_valid) begin
-                    write_active = 1'b1;
-                    write_addr = awaddr_reg[7:0];
-                    write_data_internal = wdata_reg;
+                    if (addr_is_core(awaddr_reg)) begin
+                        write_active = 1'b1;
+                        write_addr = awaddr_reg[7:0];
+                        write_data_internal = wdata_reg;
+                    end else begin
+                        fifo_write = axil.b_ready;
+                    end
                     b_chan.resp = axi_pkg::RESP_OKAY;
                 end else begin
                     b_chan.resp = axi_pkg::RESP_SLVERR;
@@ -234,6 +321,7 @@ module adam_axil_aes #(
         // Internal read control
         read_active = 1'b0;
         read_addr = 8'h00;
+        fifo_read = 1'b0;
 
         case (read_state)
             R_IDLE: begin
@@ -245,12 +333,17 @@ module adam_axil_aes #(
 
             R_DATA: begin
                 // Execute read from AES core
-                if (addr_is_valid(araddr_reg)) begin
+                if (addr_is_valid(araddr_reg) && addr_is_core(araddr_reg)) begin
                     read_active = 1'b1;
                     read_addr = araddr_reg[7:0];
                     
                     r_chan.data = aes_read_data;
                     r_chan.resp = axi_pkg::RESP_OKAY;
+                end else if (addr_is_valid(araddr_reg)) begin
+                    fifo_read = axil.r_ready;
+
+                    r_chan.data = fifo_read_data;
+                    r_chan.resp = axi_pkg::RESP_OKAY;
                 end else begin
                     r_chan.data = '0;
                     r_chan.resp = axi_pkg::RESP_SLVERR;
@@ -264,6 +357,182 @@ module adam_axil_aes #(
         endcase
     end
 
+    //----------------------------------------------------------------
+    // Block FIFOs
+    //----------------------------------------------------------------
+    always_comb begin
+        // FIFO Control Register (FCR)
+        in_watermark_level  = fifo_control[7:0];
+        out_watermark_level = fifo_control[15:8];
+
+        // FIFO flags
+        in_watermark  = (in_level <= in_watermark_level);
+        out_watermark = (out_watermark_level != 0) &&
+            (out_level >= out_watermark_level);
+
+        // FIFO Status Register (FSR)
+        fifo_status = 0;
+        fifo_status[0] = in_watermark;
+        fifo_status[1] = out_watermark;
+        fifo_status[2] = in_overrun;
+        fifo_status[3] = out_underrun;
+        fifo_status[15:8]  = in_level;
+        fifo_status[23:16] = out_level;
+
+        // FIFO Interrupt Enable Register (FIER)
+        in_watermark_ie  = fifo_interrupt_enable[0];
+        out_watermark_ie = fifo_interrupt_enable[1];
+        in_overrun_ie    = fifo_interrupt_enable[2];
+        out_underrun_ie  = fifo_interrupt_enable[3];
+
+        fifo_irq =
+            (in_watermark  && in_watermark_ie ) |
+            (out_watermark && out_watermark_ie) |
+            (in_overrun    && in_overrun_ie   ) |
+            (out_underrun  && out_underrun_ie );
+
+        // Read data, an empty output FIFO reads as 0
+        case (araddr_reg[7:0])
+            ADDR_DOUT: fifo_read_data = (out_level != 0) ?
+                out_fifo[out_rptr][(3 - out_word)*32 +: 32] : '0;
+            ADDR_FSR:  fifo_read_data = fifo_status;
+            ADDR_FCR:  fifo_read_data = fifo_control;
+            ADDR_FIER: fifo_read_data = fifo_interrupt_enable;
+            default:   fifo_read_data = '0;
+        endcase
+
+        // Feed the core as long as the output FIFO can take the result
+        stream_valid = (in_level != 0) &&
+            (out_level + in_flight < FIFO_DEPTH);
+        stream_block = in_fifo[in_rptr];
+    end
+
+    always_ff @(posedge seq.clk) begin
+        automatic logic in_push;
+        automatic logic in_pop;
+        automatic logic out_push;
+        automatic logic out_pop;
+
+        if (seq.rst) begin
+            fifo_control          <= 0;
+            fifo_interrupt_enable <= 0;
+
+            in_overrun   <= 0;
+            out_underrun <= 0;
+
+            in_rptr  <= 0;
+            in_wptr  <= 0;
+            in_level <= 0;
+            in_buf   <= 0;
+            in_word  <= 0;
+
+            out_rptr  <= 0;
+            out_wptr  <= 0;
+            out_level <= 0;
+            out_word  <= 0;
+
+            in_flight <= 0;
+            discard   <= 0;
+        end
+        else begin
+            in_push  = 0;
+            in_pop   = stream_valid && stream_ready;
+            out_push = stream_result_valid && (discard == 0);
+            out_pop  = 0;
+
+            if (fifo_write) case (awaddr_reg[7:0])
+
+                ADDR_DIN: begin
+                    if (in_word != 3) begin
+                        in_buf[(2 - in_word)*32 +: 32] <= wdata_reg;
+                    end
+                    else if (in_level != FIFO_DEPTH) begin
+                        in_fifo[in_wptr] <= {in_buf, wdata_reg};
+                        in_push = 1;
+                    end
+                    else begin
+                        // Full, the whole block is dropped
+                        in_overrun <= 1;
+                    end
+                    in_word <= in_word + 1;
+                end
+
+                ADDR_FSR: begin
+                    // Read only, except IOV and OUD which are write 1 to
+                    // clear
+                    in_overrun   <= in_overrun   & !wdata_reg[2];
+                    out_underrun <= out_underrun & !wdata_reg[3];
+                end
+
+                ADDR_FCR: begin
+                    // FLUSH (bit 16) is not kept
+                    fifo_control <= wdata_reg & 32'h0000FFFF;
+                end
+
+                ADDR_FIER: begin
+                    fifo_interrupt_enable <= wdata_reg;
+                end
+
+                default: ;
+            endcase
+
+            if (fifo_read && araddr_reg[7:0] == ADDR_DOUT) begin
+                if (out_level != 0) begin
+                    if (out_word == 3) begin
+                        out_pop = 1;
+                    end
+                    out_word <= out_word + 1;
+                end
+                else begin
+                    out_underrun <= 1;
+                end
+            end
+
+            // Core results
+            if (stream_result_valid && discard != 0) begin
+                discard <= discard - 1;
+            end
+
+            if (out_push) begin
+                out_fifo[out_wptr] <= stream_result;
+                out_wptr <= out_wptr + 1;
+            end
+
+            // FIFO pointers and levels
+            if (in_push) begin
+                in_wptr <= in_wptr + 1;
+            end
+
+            if (in_pop) begin
+                in_rptr <= in_rptr + 1;
+            end
+
+            if (out_pop) begin
+                out_rptr <= out_rptr + 1;
+            end
+
+            in_level  <= in_level + in_push - in_pop;
+            out_level <= out_level + out_push - out_pop;
+            in_flight <= in_flight + in_pop - stream_result_valid;
+
+            // Flush, both FIFOs are emptied and the blocks in the core
+            // discarded
+            if (fifo_write && awaddr_reg[7:0] == ADDR_FCR && wdata_reg[16]) begin
+                in_rptr  <= 0;
+                in_wptr  <= 0;
+                in_level <= 0;
+                in_word  <= 0;
+
+                out_rptr  <= 0;
+                out_wptr  <= 0;
+                out_level <= 0;
+                out_word  <= 0;
+
+                discard <= in_flight + in_pop - stream_result_valid;
+            end
+        end
+    end
+
     //----------------------------------------------------------------
     // AES Core signal multiplexing
     //----------------------------------------------------------------
@@ -67,13 +67,21 @@ module adam_core_cv32e40p #(
     // ========================================================================
     // CV32E40P CORE
     // ========================================================================
-    
+
+    // PULP extensions (Xpulp), enabled per target with ADAM_COREV_PULP. The
+    // kws build reads the same define to use them.
+`ifdef ADAM_COREV_PULP
+    localparam int COREV_PULP = 1;
+`else
+    localparam int COREV_PULP = 0;
+`endif
+
     cv32e40p_top #(
         .FPU              (1),
         .FPU_ADDMUL_LAT   (2),
         .FPU_OTHERS_LAT   (2),
         .ZFINX            (0),
-        .COREV_PULP       (0),
+        .COREV_PULP       (COREV_PULP),
         .COREV_CLUSTER    (0),
         .NUM_MHPMCOUNTERS (1)
     ) cv32e40p_top (
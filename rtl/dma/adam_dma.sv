@@ -0,0 +1,291 @@
+/*
+ * Descriptor-based DMA on a fabric DMA slot.
+ *
+ * The DMA has no register interface of its own, it is driven through its
+ * syscfg target: BAR holds the address of the first descriptor, RESUME (or
+ * RESET) starts the chain and IER selects the peripheral interrupts that
+ * pace transfers. A descriptor is 5 words in memory:
+ *
+ *   0x00 SRC   source address
+ *   0x04 DST   destination address
+ *   0x08 CNT   number of words
+ *   0x0C CTRL  [0] SINC  increment the source address
+ *              [1] DINC  increment the destination address
+ *              [2] PACED wait for req before each word
+ *              [30] ERR  written back on a bus error
+ *              [31] DONE written back once the descriptor completes
+ *   0x10 NEXT  next descriptor, 0 ends the chain
+ *
+ * Words are moved one bus transaction at a time. In paced mode an error
+ * response is taken as "not ready" and the word is retried on the next
+ * request, so a peripheral can be read or written as long as its FIFO has
+ * data or room. A bus error on a descriptor fetch or an unpaced transfer
+ * ends the chain after writing CTRL back with DONE and ERR. irq is raised
+ * once the chain has ended, also when that write-back fails, until the DMA
+ * is stopped or reset. The syscfg target reports it in SR.D.
+ */
+
+`include "adam/macros.svh"
+
+module adam_dma #(
+    `ADAM_CFG_PARAMS
+) (
+    ADAM_SEQ.Slave   seq,
+    ADAM_PAUSE.Slave pause,
+
+    input  ADDR_T desc_addr,
+    input  logic  req,
+    output logic  irq,
+
+    AXI_LITE.Master axil
+);
+
+    localparam DESC_SRC  = 0;
+    localparam DESC_DST  = 1;
+    localparam DESC_CNT  = 2;
+    localparam DESC_CTRL = 3;
+    localparam DESC_NEXT = 4;
+
+    localparam CTRL_SINC  = 0;
+    localparam CTRL_DINC  = 1;
+    localparam CTRL_PACED = 2;
+    localparam CTRL_ERR   = 30;
+    localparam CTRL_DONE  = 31;
+
+    typedef enum logic [2:0] {
+        START  = 0, // Load the first descriptor address
+        DESC   = 1, // Fetch the descriptor words
+        READ   = 2, // Read one source word
+        WRITE  = 3, // Write it to the destination
+        STATUS = 4, // Write CTRL back with DONE (and ERR)
+        DONE   = 5  // End of chain
+    } state_t;
+
+    state_t state;
+
+    // Current descriptor
+    ADDR_T      desc;
+    logic [2:0] field;
+    ADDR_T      src;
+    ADDR_T      dst;
+    DATA_T      count;
+    DATA_T      ctrl;
+    ADDR_T      next;
+    DATA_T      data;
+    logic       error;
+
+    // Bus transaction
+    logic  bus_req;
+    logic  bus_we;
+    ADDR_T bus_addr;
+    DATA_T bus_wdata;
+
+    logic  busy;
+    logic  aw_ok;
+    logic  w_ok;
+    logic  ar_ok;
+
+    logic  bus_done;
+    logic  bus_err;
+    DATA_T bus_rdata;
+
+    logic paced;
+
+    always_comb begin
+        paced = ctrl[CTRL_PACED];
+
+        // Next bus transaction of the current state
+        bus_req   = 0;
+        bus_we    = 0;
+        bus_addr  = 0;
+        bus_wdata = 0;
+
+        case (state)
+            DESC: begin
+                bus_req  = 1;
+                bus_addr = desc + STRB_WIDTH*field;
+            end
+
+            READ: begin
+                bus_req  = !paced || req;
+                bus_addr = src;
+            end
+
+            WRITE: begin
+                bus_req   = !paced || req;
+                bus_we    = 1;
+                bus_addr  = dst;
+                bus_wdata = data;
+            end
+
+            STATUS: begin
+                bus_req   = 1;
+                bus_we    = 1;
+                bus_addr  = desc + STRB_WIDTH*DESC_CTRL;
+                bus_wdata = ctrl | (1 << CTRL_DONE) |
+                    (DATA_T'(error) << CTRL_ERR);
+            end
+
+            default: begin
+                bus_req = 0;
+            end
+        endcase
+
+        // AXI-Lite, one transaction at a time
+        axil.aw_addr  = bus_addr;
+        axil.aw_prot  = 0;
+        axil.aw_valid = busy && bus_we && !aw_ok;
+        axil.w_data   = bus_wdata;
+        axil.w_strb   = '1;
+        axil.w_valid  = busy && bus_we && !w_ok;
+        axil.b_ready  = busy && bus_we && aw_ok && w_ok;
+
+        axil.ar_addr  = bus_addr;
+        axil.ar_prot  = 0;
+        axil.ar_valid = busy && !bus_we && !ar_ok;
+        axil.r_ready  = busy && !bus_we && ar_ok;
+
+        // force alignment
+        axil.aw_addr[$clog2(STRB_WIDTH)-1:0] = 0;
+        axil.ar_addr[$clog2(STRB_WIDTH)-1:0] = 0;
+
+        if (bus_we) begin
+            bus_done  = axil.b_valid && axil.b_ready;
+            bus_err   = (axil.b_resp != axi_pkg::RESP_OKAY);
+            bus_rdata = 0;
+        end
+        else begin
+            bus_done  = axil.r_valid && axil.r_ready;
+            bus_err   = (axil.r_resp != axi_pkg::RESP_OKAY);
+            bus_rdata = axil.r_data;
+        end
+
+        irq = (state == DONE);
+    end
+
+    always_ff @(posedge seq.clk) begin
+        if (seq.rst) begin
+            state <= START;
+
+            desc  <= 0;
+            field <= 0;
+            src   <= 0;
+            dst   <= 0;
+            count <= 0;
+            ctrl  <= 0;
+            next  <= 0;
+            data  <= 0;
+            error <= 0;
+
+            busy  <= 0;
+            aw_ok <= 0;
+            w_ok  <= 0;
+            ar_ok <= 0;
+
+            pause.ack <= 1;
+        end
+        else if (pause.req && pause.ack) begin
+            // PAUSED
+        end
+        else if (!pause.req && pause.ack) begin
+            // resume
+            pause.ack <= 0;
+        end
+        else if (pause.req && !busy) begin
+            // pause between two transactions
+            pause.ack <= 1;
+        end
+        else if (!busy) begin
+            if (state == START) begin
+                desc  <= desc_addr;
+                field <= 0;
+                error <= 0;
+                state <= DESC;
+            end
+            else if (bus_req) begin
+                busy <= 1;
+            end
+        end
+        else begin
+            // address and data phases
+            if (axil.aw_valid && axil.aw_ready) aw_ok <= 1;
+            if (axil.w_valid  && axil.w_ready)  w_ok  <= 1;
+            if (axil.ar_valid && axil.ar_ready) ar_ok <= 1;
+
+            // response
+            if (bus_done) begin
+                busy  <= 0;
+                aw_ok <= 0;
+                w_ok  <= 0;
+                ar_ok <= 0;
+
+                case (state)
+                    DESC: begin
+                        case (field)
+                            DESC_SRC:  src   <= bus_rdata;
+                            DESC_DST:  dst   <= bus_rdata;
+                            DESC_CNT:  count <= bus_rdata;
+                            DESC_CTRL: ctrl  <= bus_rdata &
+                                ~((1 << CTRL_DONE) | (1 << CTRL_ERR));
+                            default:   next  <= bus_rdata;
+                        endcase
+
+                        if (bus_err) begin
+                            // unreadable descriptor, try to flag it and
+                            // stop the chain
+                            if (field <= DESC_CTRL) ctrl <= 0;
+                            error <= 1;
+                            state <= STATUS;
+                        end
+                        else if (field == DESC_NEXT) begin
+                            state <= (count == 0) ? STATUS : READ;
+                        end
+                        else begin
+                            field <= field + 1;
+                        end
+                    end
+
+                    READ: begin
+                        if (!bus_err) begin
+                            data  <= bus_rdata;
+                            state <= WRITE;
+                        end
+                        else if (!paced) begin
+                            error <= 1;
+                            state <= STATUS;
+                        end
+                    end
+
+                    WRITE: begin
+                        if (!bus_err) begin
+                            if (ctrl[CTRL_SINC]) src <= src + STRB_WIDTH;
+                            if (ctrl[CTRL_DINC]) dst <= dst + STRB_WIDTH;
+                            count <= count - 1;
+                            state <= (count == 1) ? STATUS : READ;
+                        end
+                        else if (!paced) begin
+                            error <= 1;
+                            state <= STATUS;
+                        end
+                    end
+
+                    STATUS: begin
+                        if (error || bus_err || next == 0) begin
+                            state <= DONE;
+                        end
+                        else begin
+                            desc  <= next;
+                            field <= 0;
+                            state <= DESC;
+                        end
+                    end
+
+                    default: begin
+                        state <= state;
+                    end
+                endcase
+            end
+        end
+    end
+
+endmodule
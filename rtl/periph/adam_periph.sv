@@ -33,6 +33,11 @@ module adam_periph #(
     ADAM_IO.Master uart_rx [NO_UARTS+1]
 );
 
+    // TIMER[0] auto reload, triggers the SPI transfers
+    logic timer_trigger [NO_TIMERS+1];
+
+    assign timer_trigger[NO_TIMERS] = 0;
+
     // instatiation ===========================================================
 
     generate
@@ -85,6 +90,8 @@ module adam_periph #(
 
                 .irq (periph_irq[i]),
 
+                .trigger (timer_trigger[0]),
+
                 .sclk (spi_sclk[i-SPIS_S]),
                 .mosi (spi_mosi[i-SPIS_S]),
                 .miso (spi_miso[i-SPIS_S]),
@@ -101,7 +108,9 @@ module adam_periph #(
                 
                 .slv   (periph_apb[i]),
 
-                .irq (periph_irq[i])
+                .irq (periph_irq[i]),
+
+                .trigger (timer_trigger[i-TIMERS_S])
             );
         end
 
@@ -14,6 +14,15 @@ module adam_aes_top(
     input  logic  [7 : 0]  address,
     input  logic  [31 : 0] write_data,
     output logic [31 : 0]  read_data,
+
+    // Block stream, ciphered with the KEY and CONFIG registers while the
+    // peripheral is enabled. The results leave in order, one per cycle at
+    // most, and are not stalled.
+    input  logic           stream_valid,
+    output logic           stream_ready,
+    input  logic [127 : 0] stream_block,
+    output logic           stream_result_valid,
+    output logic [127 : 0] stream_result,
     
     // Interrupt output
     output logic           irq
@@ -78,6 +87,7 @@ module adam_aes_top(
   logic              core_ready;
   logic              core_valid;
   logic [127 : 0]    core_result;
+  logic              core_stream_ready;
 
   //----------------------------------------------------------------
   // Extract bit fields from registers
@@ -112,6 +122,10 @@ module adam_aes_top(
   logic valid_posedge;
   assign valid_posedge = core_valid && !core_valid_q;
 
+  // Stream
+  assign stream_ready  = periph_enable && core_stream_ready;
+  assign stream_result = core_result;
+
   // IRQ generation
   assign irq = periph_enable && done_event && done_event_ie;
 
@@ -127,6 +141,10 @@ module adam_aes_top(
     .result_valid(core_valid),
     .key(core_key),
     .keylen(core_keylen),
+    .stream_valid(stream_valid && periph_enable),
+    .stream_ready(core_stream_ready),
+    .stream_block(stream_block),
+    .stream_result_valid(stream_result_valid),
     .block(core_block),
     .result(core_result)
   );
@@ -174,8 +192,8 @@ module adam_aes_top(
       status_reg[STATUS_READY_BIT] <= core_ready;
       status_reg[STATUS_VALID_BIT] <= core_valid;
       
-      // Capture result when valid
-      if (core_valid) begin
+      // Capture result when valid, the stream then moves the core output
+      if (valid_posedge) begin
         result_reg <= core_result;
       end
 
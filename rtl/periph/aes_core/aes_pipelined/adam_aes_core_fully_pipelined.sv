@@ -5,6 +5,7 @@
 // Architecture:
 // - Key expansion pipelinée (11 cycles)
 // - Encipher fully pipelined (11 cycles)
+// - Stream : un bloc par cycle tant que la clé ne change pas
 //======================================================================
 
 module adam_aes_core_fully_pipelined (
@@ -21,6 +22,15 @@ module adam_aes_core_fully_pipelined (
     input  logic [255:0] key,
     input  logic         keylen,        // 0 = 128-bit, 1 = 256-bit
     
+    // Block stream, one block per cycle once the key is expanded. The
+    // results come out on result, in order, with stream_result_valid. A key
+    // change is expanded on the next stream block, once the pipeline is
+    // empty.
+    input  logic         stream_valid,
+    output logic         stream_ready,
+    input  logic [127:0] stream_block,
+    output logic         stream_result_valid,
+
     // Data
     input  logic [127:0] block,
     output logic [127:0] result
@@ -36,7 +46,14 @@ module adam_aes_core_fully_pipelined (
   logic         enc_start;
   logic         enc_ready;
   logic         enc_valid;
+  logic [127:0] enc_block;
   logic [127:0] enc_result;
+  logic         enc_in_valid;
+  logic         enc_out_valid;
+  logic [3:0]   enc_in_flight;
+
+  logic         key_expand;
+  logic         stream_key_reg;
   
   logic [255:0] prev_key_reg;     
   logic         prev_keylen_reg;  
@@ -94,7 +111,9 @@ module adam_aes_core_fully_pipelined (
     .keylen(keylen),
     .ready(enc_ready),
     .valid(enc_valid),
-    .block(block),
+    .in_valid(enc_in_valid),
+    .out_valid(enc_out_valid),
+    .block(enc_block),
     .round_keys(round_keys),
     .result(enc_result)
   );
@@ -108,6 +127,23 @@ module adam_aes_core_fully_pipelined (
   assign ready        = ready_reg;
   assign result       = enc_result;
   assign result_valid = result_valid_reg;
+
+  // Stream blocks enter while the FSM idles with the key expanded, START
+  // has priority
+  assign stream_ready        = (state_reg == CTRL_IDLE) && !start &&
+                               key_valid_reg && !key_changed;
+  assign enc_in_valid        = stream_valid && stream_ready;
+  assign enc_block           = enc_in_valid ? stream_block : block;
+  assign stream_result_valid = enc_out_valid;
+
+  // Blocks in the encipher, the key may not change under them
+  always_ff @(posedge clk or negedge reset_n) begin
+    if (!reset_n) begin
+      enc_in_flight <= 4'h0;
+    end else begin
+      enc_in_flight <= enc_in_flight + enc_in_valid - enc_out_valid;
+    end
+  end
   
   //----------------------------------------------------------------
   // Register update
@@ -120,17 +156,25 @@ module adam_aes_core_fully_pipelined (
       prev_key_reg      <= '0;
       prev_keylen_reg   <= 1'b0;
       key_valid_reg     <= 1'b0;
+      stream_key_reg    <= 1'b0;
 
     end else begin
       state_reg        <= state_next;
       result_valid_reg <= result_valid_next;
       ready_reg        <= ready_next;
 
-      if (state_reg == CTRL_IDLE && start && key_changed) begin
+      if (state_reg == CTRL_IDLE && (start || key_expand) && key_changed) begin
         prev_key_reg    <= key;
         prev_keylen_reg <= keylen;
         key_valid_reg   <= 1'b0;
       end
+
+      // Expansion for the stream, back to IDLE without a cipher
+      if (key_expand) begin
+        stream_key_reg <= 1'b1;
+      end else if (state_reg == CTRL_KEY_WAIT && key_ready) begin
+        stream_key_reg <= 1'b0;
+      end
       // Quand la key expansion est prête (toutes round_keys prêtes)
       if (state_reg == CTRL_KEY_WAIT && key_ready) begin
         key_valid_reg <= 1'b1;
@@ -149,6 +193,7 @@ module adam_aes_core_fully_pipelined (
     ready_next        = ready_reg;
     key_init          = 1'b0;
     enc_start         = 1'b0;
+    key_expand        = 1'b0;
     
     case (state_reg)
       //------------------------------------------------------------
@@ -169,6 +214,11 @@ module adam_aes_core_fully_pipelined (
             state_next = CTRL_CIPHER_START;
           end
 
+        end else if (stream_valid && key_changed && enc_in_flight == 4'h0) begin
+          key_init   = 1'b1;
+          key_expand = 1'b1;
+          ready_next = 1'b0;
+          state_next = CTRL_KEY_INIT;
         end
       end
       
@@ -181,7 +231,7 @@ module adam_aes_core_fully_pipelined (
       //------------------------------------------------------------
       CTRL_KEY_WAIT: begin
         if (key_ready) begin
-          state_next = CTRL_CIPHER_START;
+          state_next = stream_key_reg ? CTRL_IDLE : CTRL_CIPHER_START;
         end
       end
       
@@ -16,6 +16,12 @@ module adam_aes_encipher_fully_pipelined (
     input  logic         keylen,
     output logic         ready,
     output logic         valid,
+
+    // Stream, one block per cycle with the round keys held. A block
+    // presented with in_valid comes out LATENCY cycles later with
+    // out_valid, on result.
+    input  logic         in_valid,
+    output logic         out_valid,
     
     // Data
     input  logic [127:0] block,
@@ -42,6 +48,14 @@ module adam_aes_encipher_fully_pipelined (
   //----------------------------------------------------------------
   logic [4:0]   cycle_counter_reg, cycle_counter_next;
   logic         pipeline_active_reg, pipeline_active_next;
+
+  // Stages holding a stream block. The pipeline advances every cycle while
+  // one is in flight, so none of them is ever stalled.
+  logic [LATENCY-1:0] valid_chain;
+  logic               advance;
+
+  assign advance   = pipeline_active_reg || in_valid || (|valid_chain);
+  assign out_valid = valid_chain[LATENCY-1];
   
   //----------------------------------------------------------------
   // FSM
@@ -127,10 +141,12 @@ module adam_aes_encipher_fully_pipelined (
     if (!reset_n) begin
       for (int s = 0; s <= 9; s++)
         stage_reg[s] <= 128'h0;
+      valid_chain <= '0;
     end else begin
-      if (pipeline_active_reg) begin
+      if (advance) begin
         for (int s = 0; s <= 9; s++)
           stage_reg[s] <= stage_next[s];
+        valid_chain <= {valid_chain[LATENCY-2:0], in_valid};
       end
     end
   end
@@ -1,7 +1,15 @@
 `include "adam/macros.svh"
 
 module adam_periph_spi #(
-    `ADAM_CFG_PARAMS
+    `ADAM_CFG_PARAMS,
+
+    // Power of two, at most 128
+    parameter RX_FIFO_DEPTH = 16,
+
+    // Dependent parameters, DO NOT OVERRIDE!
+
+    parameter RX_PTR_WIDTH   = $clog2(RX_FIFO_DEPTH),
+    parameter RX_LEVEL_WIDTH = $clog2(RX_FIFO_DEPTH+1)
 ) (
     ADAM_SEQ.Slave   seq,
     ADAM_PAUSE.Slave pause,
@@ -10,6 +18,9 @@ module adam_periph_spi #(
 
     output logic irq,
 
+    // Transfer trigger pulse (TIMER[0] auto reload)
+    input logic trigger,
+
     ADAM_IO.Master sclk,
     ADAM_IO.Master mosi,
     ADAM_IO.Master miso,
@@ -26,7 +37,10 @@ module adam_periph_spi #(
     ) tx ();
     
     // Data (RX)
-    DATA_T rx_buf;
+    DATA_T rx_fifo [RX_FIFO_DEPTH];
+    logic [RX_PTR_WIDTH-1:0]   rx_rptr;
+    logic [RX_PTR_WIDTH-1:0]   rx_wptr;
+    logic [RX_LEVEL_WIDTH-1:0] rx_level;
     ADAM_STREAM #(
         .T (DATA_T)
     ) rx ();
@@ -36,6 +50,7 @@ module adam_periph_spi #(
     DATA_T status;
     DATA_T baud_rate;
     DATA_T interrupt_enable;
+    DATA_T fifo_control;
 
     // Control Register (CR)
     logic       periph_enable;
@@ -48,12 +63,20 @@ module adam_periph_spi #(
     logic [7:0] data_length;
 
     // Status Register (SR)
-    logic tx_buf_empty;   // Transmit Buffer Empty
-    logic rx_buf_full; // Receive Buffer Full
+    logic tx_buf_empty; // Transmit Buffer Empty
+    logic rx_buf_full;  // Receive Buffer Full (RX FIFO not empty)
+    logic rx_watermark; // RX FIFO Watermark
+    logic rx_overrun;   // RX Overrun
     
     // Interrupt Enable Regiter (IER)
     logic tx_buf_empty_ie; // Transmit Buffer Empty Interrupt Enable
     logic rx_buf_full_ie;  // Receiver Buffer Full Interrupt Enable
+    logic rx_watermark_ie; // RX FIFO Watermark Interrupt Enable
+    logic rx_overrun_ie;   // RX Overrun Interrupt Enable
+
+    // FIFO Control Register (FCR)
+    logic [7:0] rx_watermark_level;
+    logic       trigger_enable;
 
     // APB
     ADDR_T paddr;
@@ -127,19 +150,35 @@ module adam_periph_spi #(
         data_order     = control[6];
         data_length    = control[15:8];
 
+        // FIFO Control Register (FCR)
+        rx_watermark_level = fifo_control[7:0];
+        trigger_enable     = fifo_control[8];
+
+        // RX FIFO flags
+        rx_buf_full  = (rx_level != 0);
+        rx_watermark = (rx_watermark_level != 0) &&
+            (rx_level >= rx_watermark_level);
+
         // Status Register (SR)
+        status = 0;
         status[0] = tx_buf_empty;
         status[1] = rx_buf_full;
-        status[DATA_WIDTH-1:2] = 0;
+        status[2] = rx_watermark;
+        status[3] = rx_overrun;
+        status[15:8] = rx_level;
 
         // Interrupt Enable Register (IER)
         tx_buf_empty_ie  = interrupt_enable[0];
         rx_buf_full_ie   = interrupt_enable[1];
+        rx_watermark_ie  = interrupt_enable[2];
+        rx_overrun_ie    = interrupt_enable[3];
 
         // IRQ
         irq = (periph_enable && !pause.ack) && (
             (tx_buf_empty && tx_buf_empty_ie && tx_enable) |
-            (rx_buf_full  && rx_buf_full_ie  && rx_enable)
+            (rx_buf_full  && rx_buf_full_ie  && rx_enable) |
+            (rx_watermark && rx_watermark_ie && rx_enable) |
+            (rx_overrun   && rx_overrun_ie   && rx_enable)
         );
 
         slv_pause.req = pause.req;
@@ -154,23 +193,28 @@ module adam_periph_spi #(
 
         // Submodule transfers
         tx.valid = !tx_buf_empty;
-        rx.ready = !rx_buf_full;
+        rx.ready = (rx_level != RX_FIFO_DEPTH);
 
         tx.data = tx_buf;
     end
 
     always_ff @(posedge seq.clk) begin
         automatic DATA_T new_control;
+        automatic logic  rx_pop;
 
         if (seq.rst) begin
             tx_buf           <= 0;
-            rx_buf           <= 0;
             control          <= 0;
             baud_rate        <= 0;
             interrupt_enable <= 0;
+            fifo_control     <= 0;
 
             tx_buf_empty <= 1;
-            rx_buf_full  <= 0;
+            rx_overrun   <= 0;
+
+            rx_rptr  <= 0;
+            rx_wptr  <= 0;
+            rx_level <= 0;
 
             prdata  <= 0;
             pready  <= 0;
@@ -184,6 +228,8 @@ module adam_periph_spi #(
             // PAUSED
         end
         else begin
+            rx_pop = 0;
+
             if (
                 (!slv_pause.req) &&   // no pause request
                 (psel && !pready) // pending APB transaction
@@ -205,9 +251,9 @@ module adam_periph_spi #(
                     end
                     else begin
                         if(periph_enable && rx_enable && rx_buf_full) begin
-                            // Reception
-                            prdata <= rx_buf;
-                            rx_buf_full <= 0;
+                            // Reception, pop the RX FIFO
+                            prdata <= rx_fifo[rx_rptr];
+                            rx_pop = 1;
                             pready <= 1;
                         end
                         else begin
@@ -250,7 +296,8 @@ module adam_periph_spi #(
 
                 12'h002: begin // Status Register (SR)
                     if (pwrite) begin
-                        pslverr <= 1; // read only
+                        // read only, except ROV which is write 1 to clear
+                        rx_overrun <= rx_overrun & !(pwdata[3] & mask[3]);
                     end
                     else begin
                         prdata <= status;
@@ -282,6 +329,18 @@ module adam_periph_spi #(
                     pready <= 1;
                 end
 
+                12'h005: begin // FIFO Control Register (FCR)
+                    if (pwrite) begin
+                        fifo_control <=
+                            (pwdata & mask) | (fifo_control & ~mask);
+                    end
+                    else begin
+                        prdata <= fifo_control;
+                    end
+
+                    pready <= 1;
+                end
+
                 default: begin // Error
                     pready <= 1;
                     pslverr <= 1;
@@ -325,8 +384,8 @@ module adam_periph_spi #(
 
             /*
              * Due to combinary logic, it is garanteed that the previous
-             * assigments to tx_buf_empty and rx_buf_full will not be
-             * overwritten by the following assigments.
+             * assigments to tx_buf_empty will not be overwritten by the
+             * following assigments.
              */
             
             // TX complete, buffer is empty
@@ -334,10 +393,39 @@ module adam_periph_spi #(
                 tx_buf_empty <= 1;
             end
 
-            // RX complete, buffer is full
-            if (rx.valid && rx.ready) begin
-                rx_buf <= rx.data;
-                rx_buf_full <= 1;
+            // Triggered transfer, resend the last word written to DR. A
+            // trigger that finds the previous transfer pending or the RX
+            // FIFO full is dropped.
+            if (
+                (trigger && trigger_enable) &&
+                (periph_enable && tx_enable)
+            ) begin
+                if (tx_buf_empty && rx_level != RX_FIFO_DEPTH) begin
+                    tx_buf_empty <= 0;
+                end
+                else begin
+                    rx_overrun <= 1;
+                end
+            end
+
+            // RX complete, push to the FIFO
+            if (!periph_enable) begin
+                rx_rptr    <= 0;
+                rx_wptr    <= 0;
+                rx_level   <= 0;
+                rx_overrun <= 0;
+            end
+            else begin
+                if (rx.valid && rx.ready) begin
+                    rx_fifo[rx_wptr] <= rx.data;
+                    rx_wptr <= rx_wptr + 1;
+                end
+
+                if (rx_pop) begin
+                    rx_rptr <= rx_rptr + 1;
+                end
+
+                rx_level <= rx_level + (rx.valid && rx.ready) - rx_pop;
             end
         end
     end
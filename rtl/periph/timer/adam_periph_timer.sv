@@ -8,7 +8,10 @@ module adam_periph_timer #(
 
     APB.Slave slv,
 
-    output logic irq
+    output logic irq,
+
+    // One cycle pulse on every auto reload, drives the SPI triggers
+    output logic trigger
 );
 
     // Registers
@@ -96,13 +99,17 @@ module adam_periph_timer #(
             pslverr <= 0;
 
             clk_count <= 0;
+            trigger   <= 0;
 
             pause.ack <= 1;
         end
         else if (pause.req && pause.ack) begin
             // PAUSED
+            trigger <= 0;
         end
         else begin
+            trigger <= 0;
+
             if (
                 (!pause.req) &&   // no pause request
                 (psel && !pready) // pending APB transaction
@@ -219,6 +226,7 @@ module adam_periph_timer #(
                     if (value == auto_reload) begin
                         events[0] <= 1; // Auto Reload Event
                         value     <= 0;
+                        trigger   <= 1;
                     end
                     else begin
                         value <= value + 1;
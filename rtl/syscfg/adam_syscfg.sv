@@ -39,9 +39,11 @@ module adam_syscfg #(
     output ADDR_T     cpu_boot_addr [NO_CPUS+1],
     output logic      cpu_irq       [NO_CPUS+1],
 
-    output logic      dma_rst   [NO_DMAS+1],
-    ADAM_PAUSE.Master dma_pause [NO_DMAS+1],
-    output logic      dma_irq   [NO_DMAS+1],
+    output logic      dma_rst       [NO_DMAS+1],
+    ADAM_PAUSE.Master dma_pause     [NO_DMAS+1],
+    output ADDR_T     dma_boot_addr [NO_DMAS+1],
+    output logic      dma_irq       [NO_DMAS+1],
+    input  logic      dma_done      [NO_DMAS+1],
 
     output logic      mem_rst   [NO_MEMS+1],
     ADAM_PAUSE.Master mem_pause [NO_MEMS+1],
@@ -62,6 +64,20 @@ module adam_syscfg #(
     localparam NO_TGTS = 4 + EN_LSPA + EN_LSPB + EN_HSP + EN_LPCPU + EN_LPMEM +
         NO_CPUS + NO_DMAS + NO_MEMS + NO_LSPAS + NO_LSPBS;
     
+    localparam NO_IRQ = NO_LSPAS + NO_LSPBS + NO_HSPS + NO_DMAS; 
+
+    localparam IRQ_LSPA_S = 0;
+    localparam IRQ_LSPA_E = IRQ_LSPA_S + NO_LSPAS;
+
+    localparam IRQ_LSPB_S = IRQ_LSPA_E;
+    localparam IRQ_LSPB_E = IRQ_LSPB_S + NO_LSPBS;
+
+    localparam IRQ_HSP_S = IRQ_LSPB_E;
+    localparam IRQ_HSP_E = IRQ_HSP_S + NO_HSPS;
+
+    localparam IRQ_DMA_S = IRQ_HSP_E;
+    localparam IRQ_DMA_E = IRQ_DMA_S + NO_DMAS;
+
     DATA_T irq_vec;
 
     // Pause ==================================================================
@@ -396,8 +412,9 @@ module adam_syscfg #(
                 `ADAM_CFG_PARAMS_MAP,
 
                 .EN_BOOTSTRAP (0),
-                .EN_BOOT_ADDR (0),
-                .EN_IRQ       (1)
+                .EN_BOOT_ADDR (1),
+                .EN_IRQ       (1),
+                .DONE_IRQ     (IRQ_DMA_S + i-DMA_S)
             ) tgt_dma (
                 .seq   (seq),
                 .pause (tgt_pause[i]),
@@ -406,10 +423,10 @@ module adam_syscfg #(
 
                 .irq_vec (irq_vec),
 
-                .tgt_rst       (dma_rst  [i-DMA_S]),        
-                .tgt_pause     (dma_pause[i-DMA_S]),
-                .tgt_boot_addr (),
-                .tgt_irq       (dma_irq  [i-DMA_S])
+                .tgt_rst       (dma_rst      [i-DMA_S]),        
+                .tgt_pause     (dma_pause    [i-DMA_S]),
+                .tgt_boot_addr (dma_boot_addr[i-DMA_S]),
+                .tgt_irq       (dma_irq      [i-DMA_S])
             );
         end
 
@@ -505,17 +522,6 @@ module adam_syscfg #(
 
     // irq mapping ============================================================
 
-    localparam NO_IRQ = NO_LSPAS + NO_LSPBS + NO_HSPS; 
-
-    localparam IRQ_LSPA_S = 0;
-    localparam IRQ_LSPA_E = IRQ_LSPA_S + NO_LSPAS;
-
-    localparam IRQ_LSPB_S = IRQ_LSPA_E;
-    localparam IRQ_LSPB_E = IRQ_LSPB_S + NO_LSPBS;
-
-    localparam IRQ_HSP_S = IRQ_LSPB_E;
-    localparam IRQ_HSP_E = IRQ_HSP_S + NO_HSPS;
-
     generate
         for (genvar i = 0; i < DATA_WIDTH; i++) begin
             if (i >= IRQ_LSPA_S && i < IRQ_LSPA_E) begin
@@ -527,6 +533,9 @@ module adam_syscfg #(
             else if (i >= IRQ_HSP_S && i < IRQ_HSP_E) begin
                 assign irq_vec[i] = hsp_irq[i-IRQ_HSP_S];
             end
+            else if (i >= IRQ_DMA_S && i < IRQ_DMA_E) begin
+                assign irq_vec[i] = dma_done[i-IRQ_DMA_S];
+            end
             else begin
                 assign irq_vec[i] = '0;
             end
@@ -5,7 +5,10 @@ module adam_syscfg_tgt #(
 
     parameter EN_BOOTSTRAP = 0,
     parameter EN_BOOT_ADDR = 0,
-    parameter EN_IRQ       = 0
+    parameter EN_IRQ       = 0,
+
+    // Line of irq_vec reported as SR.D (end of a DMA chain), -1 for none
+    parameter DONE_IRQ     = -1
 ) (
     ADAM_SEQ.Slave   seq,
     ADAM_PAUSE.Slave pause,
@@ -42,9 +45,19 @@ module adam_syscfg_tgt #(
     action_t action;
     logic    paused;
     logic    stopped;
+    logic    done;
+
+    generate
+        if (DONE_IRQ >= 0) begin
+            assign done = irq_vec[DONE_IRQ];
+        end
+        else begin
+            assign done = 1'b0;
+        end
+    endgenerate
 
     assign mr = {{(DATA_WIDTH-4){1'b0}}, action};
-    assign sr = {{(DATA_WIDTH-2){1'b0}}, stopped, paused};
+    assign sr = {{(DATA_WIDTH-3){1'b0}}, done, stopped, paused};
 
     action_t state;
 
@@ -295,6 +295,7 @@ def atgen(*args, **kwargs):
     yml_path = atgen_path / 'target.yml'
     pkg_path = atgen_path / 'adam_cfg_pkg.sv'
     ral_path = atgen_path / 'adam_ral.h'
+    ral_cxx_path = atgen_path / 'adam_ral.hpp'
 
     with open(yml_path, 'w') as file:
         yaml.dump(target, file)
@@ -302,7 +303,8 @@ def atgen(*args, **kwargs):
     cmd = ['python', gen_pkg_path, yml_path, '-o', pkg_path, '-t', target_name]
     exec_cmd(cmd, atgen_path, loggers['atgen'])
 
-    cmd = ['python', gen_ral_path, yml_path, '-o', ral_path, '-t', target_name]
+    cmd = ['python', gen_ral_path, yml_path, '-o', ral_path, '-t', target_name,
+        '--cxx', ral_cxx_path]
     exec_cmd(cmd, atgen_path, loggers['atgen'])
 
 
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+gen_audio_clip.py is a command-line tool that generates a C header with a
+fixed audio clip for the KWS benchmark. The clip is read from a 16-bit mono
+WAV file at the capture sample rate or, without one, synthesized from a
+seeded generator: silence, a tone burst, noise and silence again. The same
+arguments always produce the same clip.
+"""
+
+import argparse
+import math
+import os
+import sys
+import wave
+
+from gen_banner import banner
+
+INT16_MIN = -32768
+INT16_MAX = 32767
+
+class Lcg:
+    """Numerical Recipes LCG, independent of the Python random module."""
+
+    def __init__(self, seed):
+        self.state = seed & 0xFFFFFFFF
+
+    def next(self):
+        self.state = (self.state * 1664525 + 1013904223) & 0xFFFFFFFF
+        return self.state
+
+    # Uniform in [-1, 1)
+    def uniform(self):
+        return self.next() / 2**31 - 1
+
+def clamp(x):
+    return max(INT16_MIN, min(INT16_MAX, int(round(x))))
+
+def load_wav(path, rate):
+    with wave.open(path, 'rb') as file:
+        if file.getnchannels() != 1 or file.getsampwidth() != 2:
+            raise ValueError(f'{path}: expected 16-bit mono')
+        if file.getframerate() != rate:
+            raise ValueError(f'{path}: expected {rate} Hz, '
+                             f'got {file.getframerate()} Hz')
+        data = file.readframes(file.getnframes())
+
+    return [int.from_bytes(data[i:i + 2], 'little', signed=True)
+            for i in range(0, len(data), 2)]
+
+def synthesize(rate, seed):
+    lcg = Lcg(seed)
+    samples = []
+
+    # 500 ms of low noise, below any sensible activity threshold
+    for _ in range(rate // 2):
+        samples.append(clamp(16 * lcg.uniform()))
+
+    # 500 ms voiced burst, 300 Hz with harmonics and a smooth envelope
+    n = rate // 2
+    for i in range(n):
+        t = i / rate
+        env = math.sin(math.pi * i / n)
+        x = sum(math.sin(2 * math.pi * 300 * k * t) / k for k in (1, 2, 3))
+        samples.append(clamp(8000 * env * x + 64 * lcg.uniform()))
+
+    # 250 ms unvoiced burst
+    for _ in range(rate // 4):
+        samples.append(clamp(4000 * lcg.uniform()))
+
+    # 750 ms of low noise
+    for _ in range(3 * rate // 4):
+        samples.append(clamp(16 * lcg.uniform()))
+
+    return samples
+
+def write_header(samples, source, out):
+    lines = []
+    put = lines.append
+
+    put(banner('KWS benchmark clip', 'gen_audio_clip.py',
+        [('Source', source)]))
+    put('')
+    put('#pragma once')
+    put('')
+    put('#include <stdint.h>')
+    put('')
+    put(f'#define KWS_CLIP_SIZE {len(samples)}')
+    put('')
+    put('static const int16_t kws_clip[KWS_CLIP_SIZE] = {')
+    for i in range(0, len(samples), 12):
+        put('    ' + ', '.join(str(x) for x in samples[i:i + 12]) + ',')
+    put('};')
+    put('')
+
+    with open(out, 'w') as file:
+        file.write('\n'.join(lines))
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument('wav', type=str, nargs='?', default='',
+        help='16-bit mono WAV file, synthesized clip if empty.')
+    parser.add_argument('-r', '--rate', type=int, default=16000,
+        help='Capture sample rate in Hz.')
+    parser.add_argument('-s', '--seed', type=int, default=1,
+        help='Seed of the synthesized clip.')
+    parser.add_argument('-o', '--output', type=str, required=True,
+        help='Output C header file.')
+
+    args = parser.parse_args()
+
+    try:
+        if args.wav:
+            samples = load_wav(args.wav, args.rate)
+            source = os.path.basename(args.wav)
+        else:
+            samples = synthesize(args.rate, args.seed)
+            source = f'synthesized, seed {args.seed}'
+        if not samples:
+            raise ValueError('empty clip')
+    except (OSError, ValueError, wave.Error) as e:
+        print(f'gen_audio_clip.py: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    write_header(samples, source, args.output)
@@ -0,0 +1,35 @@
+"""
+gen_banner.py holds the comment banner shared by the KWS header generators
+(gen_op_resolver.py, gen_frontend.py and gen_audio_clip.py).
+"""
+
+from datetime import datetime, timezone
+
+banner_template = """
+/*
+ * ============================================================================
+ * {title}
+ * ============================================================================
+ *
+ * This header was auto-generated using {script}.
+ *
+{fields}
+ *
+ * It is not recommended to modify this file.
+ * ============================================================================
+ */
+"""
+
+def banner(title, script, fields):
+    """Returns the banner of a generated header. fields is a list of
+    (name, value) pairs listed after the generation date."""
+    fields = [('Date', datetime.now(timezone.utc).strftime(
+        '%Y-%m-%d %H:%M:%S UTC'))] + list(fields)
+    width = max(len(name) for name, _ in fields)
+
+    return banner_template.strip().format(
+        title=title,
+        script=script,
+        fields='\n'.join(f' * {name:<{width}} : {value}'
+                         for name, value in fields)
+    )
@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""
+gen_frontend.py is a command-line tool that generates the C header of the
+native KWS audio frontend from the TFLM audio preprocessor model. The model
+graph is checked against the sequence of signal ops the frontend fuses
+(window, FFT auto scale, RFFT, energy, filter bank, square root, spectral
+subtraction, PCAN, log and int8 quantization), then the op options and the
+constant tensors are written out as macros and tables.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+from gen_banner import banner
+
+from gen_op_resolver import FlatBuffer, load_model, builtin_ops, \
+    BUILTIN_CUSTOM
+
+# Ops of the preprocessor graph, in order
+expected_ops = [
+    'SignalWindow', 'Reshape', 'SignalFftAutoScale', 'SignalRfft',
+    'SignalEnergy', 'Cast', 'StridedSlice', 'Concatenation', 'Cast',
+    'SignalFilterBank', 'SignalFilterBankSquareRoot',
+    'SignalFilterBankSpectralSubtraction', 'SignalPCAN',
+    'SignalFilterBankLog', 'Cast', 'Mul', 'Add', 'Div', 'Add', 'Minimum',
+    'Maximum', 'Cast',
+]
+
+# TensorType values of the TFLite schema
+INT16 = 7
+INT32 = 2
+
+# Flexbuffers ================================================================
+
+def flex_uint(data, pos, width):
+    return int.from_bytes(data[pos:pos + width], 'little')
+
+def flex_int(data, pos, width):
+    return int.from_bytes(data[pos:pos + width], 'little', signed=True)
+
+# Scalars and maps only, which is all the signal ops use
+def flex_value(data, pos, width, packed):
+    kind = packed >> 2
+    if kind == 1:
+        return flex_int(data, pos, width)
+    if kind == 2:
+        return flex_uint(data, pos, width)
+    if kind == 26:
+        return bool(flex_uint(data, pos, width))
+    if kind == 9:
+        child = 1 << (packed & 3)
+        addr = pos - flex_uint(data, pos, width)
+        size = flex_uint(data, addr - child, child)
+        keys_width = flex_uint(data, addr - 2*child, child)
+        keys = addr - 3*child - flex_uint(data, addr - 3*child, child)
+        types = addr + size*child
+        value = {}
+        for i in range(size):
+            key = keys + i*keys_width
+            key -= flex_uint(data, key, keys_width)
+            name = data[key:data.index(b'\0', key)].decode()
+            value[name] = flex_value(data, addr + i*child, child,
+                                     data[types + i])
+        return value
+    raise ValueError(f'unsupported flexbuffer type {kind}')
+
+def flex_root(data):
+    width = data[-1]
+    return flex_value(data, len(data) - 2 - width, width, data[-2])
+
+# Model ======================================================================
+
+class Graph:
+    def __init__(self, path):
+        fb = FlatBuffer(load_model(path))
+        if fb.data[4:8] != b'TFL3':
+            raise ValueError(f'{path}: not a TFLite model')
+        self.fb = fb
+
+        model = fb.root()
+        codes = []
+        for entry in fb.vector(fb.field(model, 1)):
+            code = fb.table(entry)
+            deprecated = fb.field(code, 0)
+            custom = fb.field(code, 1)
+            builtin = fb.field(code, 3)
+            op = max(fb.i8(deprecated) if deprecated else 0,
+                     fb.i32(builtin) if builtin else 0)
+            codes.append(fb.string(custom) if op == BUILTIN_CUSTOM
+                         else builtin_ops.get(op, str(op)))
+
+        self.buffers = [fb.table(e) for e in fb.vector(fb.field(model, 4))]
+
+        subgraph = fb.table(fb.vector(fb.field(model, 2))[0])
+        self.tensors = [fb.table(e) for e in fb.vector(fb.field(subgraph, 0))]
+
+        self.ops = []
+        for entry in fb.vector(fb.field(subgraph, 3)):
+            op = fb.table(entry)
+            index = fb.field(op, 0)
+            name = codes[fb.u32(index) if index else 0]
+            options = {}
+            custom = fb.field(op, 5)
+            if custom:
+                vec = custom + fb.u32(custom)
+                options = flex_root(fb.data[vec + 4:vec + 4 + fb.u32(vec)])
+            self.ops.append((name, self.ints(fb.field(op, 1)), options))
+
+    def ints(self, pos):
+        return [self.fb.i32(p) for p in self.fb.vector(pos)] if pos else []
+
+    # Contents of a constant tensor
+    def const(self, index):
+        fb = self.fb
+        tensor = self.tensors[index]
+        kind = fb.data[fb.field(tensor, 1)] if fb.field(tensor, 1) else 0
+        data = fb.field(self.buffers[fb.u32(fb.field(tensor, 2))], 0)
+        if not data:
+            raise ValueError(f'tensor {index} is not a constant')
+        vec = data + fb.u32(data)
+        raw = fb.data[vec + 4:vec + 4 + fb.u32(vec)]
+        if kind == INT16:
+            return list(struct.unpack(f'<{len(raw) // 2}h', raw))
+        if kind == INT32:
+            return list(struct.unpack(f'<{len(raw) // 4}i', raw))
+        raise ValueError(f'tensor {index}: unsupported type {kind}')
+
+    def scalar(self, index):
+        value = self.const(index)
+        if len(value) != 1:
+            raise ValueError(f'tensor {index} is not a scalar')
+        return value[0]
+
+def extract(graph):
+    names = [name for name, _, _ in graph.ops]
+    if names != expected_ops:
+        raise ValueError('unexpected preprocessor graph: ' + ', '.join(names))
+
+    ops = graph.ops
+    p = {}
+
+    _, inputs, options = ops[0]
+    p['window'] = graph.const(inputs[1])
+    p['window_shift'] = options['shift']
+
+    p['fft_length'] = ops[3][2]['fft_length']
+    p['energy_start'] = ops[4][2]['start_index']
+    p['energy_end'] = ops[4][2]['end_index']
+
+    # The slice and concatenation zero the bins outside the energy range
+    _, inputs, _ = ops[6]
+    if graph.const(inputs[1]) != [p['energy_start']] or \
+            graph.const(inputs[2]) != [p['energy_end']] or \
+            graph.const(inputs[3]) != [1]:
+        raise ValueError('spectrum slice does not match the energy range')
+
+    _, inputs, options = ops[9]
+    p['channels'] = options['num_channels']
+    p['weights'] = graph.const(inputs[1])
+    p['unweights'] = graph.const(inputs[2])
+    p['channel_starts'] = graph.const(inputs[3])
+    p['channel_weight_starts'] = graph.const(inputs[4])
+    p['channel_widths'] = graph.const(inputs[5])
+
+    p['nr'] = ops[11][2]
+
+    _, inputs, options = ops[12]
+    p['pcan_lut'] = graph.const(inputs[2])
+    p['pcan_snr_shift'] = options['snr_shift']
+
+    p['log_scale'] = ops[13][2]['output_scale']
+    p['log_correction_bits'] = ops[13][2]['input_correction_bits']
+
+    # int8 = clamp((log * MUL + ADD) / DIV + ZP, MIN, MAX)
+    p['quant_mul'] = graph.scalar(ops[15][1][1])
+    p['quant_add'] = graph.scalar(ops[16][1][1])
+    p['quant_div'] = graph.scalar(ops[17][1][1])
+    p['quant_zp'] = graph.scalar(ops[18][1][1])
+    p['quant_max'] = graph.scalar(ops[19][1][1])
+    p['quant_min'] = graph.scalar(ops[20][1][1])
+
+    if p['quant_mul'] <= 0 or p['quant_add'] < 0 or p['quant_div'] <= 0:
+        raise ValueError('unsupported feature quantization')
+
+    if len(p['channel_starts']) != p['channels'] + 1:
+        raise ValueError('filter bank tables do not match num_channels')
+
+    # The frontend only keeps the spectrum bins up to fft_length / 2
+    bins = p['fft_length'] // 2 + 1
+    for start, width in zip(p['channel_starts'], p['channel_widths']):
+        if start < 0 or start + width > bins:
+            raise ValueError('filter bank reads past the spectrum')
+    if len(p['window']) > p['fft_length']:
+        raise ValueError('window longer than the FFT')
+
+    return p
+
+# Division by a multiply and a shift. With mul = ceil(2^shift / div), the
+# quotient is exact for every n <= limit as long as n * (mul * div - 2^shift)
+# stays below 2^shift.
+def magic_divider(div, limit):
+    for shift in range(64):
+        mul = -(-(1 << shift) // div)
+        if mul >= 1 << 32:
+            break
+        if limit * (mul * div - (1 << shift)) < 1 << shift:
+            return mul, shift
+    raise ValueError(f'no multiply-shift divider for {div}')
+
+def table(name, values):
+    lines = [f'static const int16_t {name}[{len(values)}] = {{']
+    for i in range(0, len(values), 12):
+        lines.append('    ' + ', '.join(str(x) for x in values[i:i + 12])
+                     + ',')
+    lines.append('};')
+    return lines
+
+def write_header(p, model, out):
+    lines = []
+    put = lines.append
+
+    put(banner('KWS audio frontend parameters', 'gen_frontend.py',
+        [('Model', os.path.basename(model))]))
+    put('')
+    put('#pragma once')
+    put('')
+    put('#include <stdint.h>')
+    put('')
+
+    nr = p['nr']
+    limit = 0x7FFF * p['quant_mul'] + p['quant_add']
+    mul, shift = magic_divider(p['quant_div'], limit)
+
+    macros = [
+        ('FRONTEND_FRAME_SIZE', len(p['window'])),
+        ('FRONTEND_WINDOW_SHIFT', p['window_shift']),
+        ('FRONTEND_FFT_LENGTH', p['fft_length']),
+        ('FRONTEND_ENERGY_START', p['energy_start']),
+        ('FRONTEND_ENERGY_END', p['energy_end']),
+        ('FRONTEND_CHANNELS', p['channels']),
+        ('FRONTEND_NR_SMOOTHING', nr['smoothing']),
+        ('FRONTEND_NR_ONE_MINUS_SMOOTHING', nr['one_minus_smoothing']),
+        ('FRONTEND_NR_ALT_SMOOTHING', nr['alternate_smoothing']),
+        ('FRONTEND_NR_ALT_ONE_MINUS_SMOOTHING',
+            nr['alternate_one_minus_smoothing']),
+        ('FRONTEND_NR_SMOOTHING_BITS', nr['smoothing_bits']),
+        ('FRONTEND_NR_MIN_SIGNAL_REMAINING', nr['min_signal_remaining']),
+        ('FRONTEND_NR_CLAMPING', int(nr['clamping'])),
+        ('FRONTEND_NR_BITS', nr['spectral_subtraction_bits']),
+        ('FRONTEND_PCAN_SNR_SHIFT', p['pcan_snr_shift']),
+        ('FRONTEND_LOG_SCALE', p['log_scale']),
+        ('FRONTEND_LOG_CORRECTION_BITS', p['log_correction_bits']),
+        ('FRONTEND_QUANT_MUL', p['quant_mul']),
+        ('FRONTEND_QUANT_ADD', p['quant_add']),
+        ('FRONTEND_QUANT_DIV_MUL', f'{mul}u'),
+        ('FRONTEND_QUANT_DIV_SHIFT', shift),
+        ('FRONTEND_QUANT_ZERO_POINT', p['quant_zp']),
+        ('FRONTEND_QUANT_MIN', p['quant_min']),
+        ('FRONTEND_QUANT_MAX', p['quant_max']),
+    ]
+    for name, value in macros:
+        put(f'#define {name} {value}')
+    put('')
+    put(f'// (n * FRONTEND_QUANT_DIV_MUL) >> FRONTEND_QUANT_DIV_SHIFT is '
+        f'n / {p["quant_div"]}')
+    put('')
+
+    for name in ('window', 'weights', 'unweights', 'channel_starts',
+                 'channel_weight_starts', 'channel_widths', 'pcan_lut'):
+        lines += table(f'frontend_{name}', p[name])
+        put('')
+
+    with open(out, 'w') as file:
+        file.write('\n'.join(lines))
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument('model', type=str,
+        help='.tflite file or C header of the audio preprocessor model.')
+    parser.add_argument('-o', '--output', type=str, required=True,
+        help='Output C header file.')
+
+    args = parser.parse_args()
+
+    try:
+        params = extract(Graph(args.model))
+    except (OSError, ValueError, KeyError, IndexError) as e:
+        print(f'gen_frontend.py: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    write_header(params, args.model, args.output)
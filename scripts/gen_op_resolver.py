@@ -0,0 +1,233 @@
+#!/usr/bin/env python3
+"""
+gen_op_resolver.py is a command-line tool that generates a C++ header with
+exact TFLM op resolvers for a set of models. The models are read from .tflite
+files or from the C arrays of xxd-style headers. For each model the header
+defines <Name>OpResolver, a MicroMutableOpResolver sized to the operators the
+model uses, and Register<Name>Ops(), which adds exactly those operators.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+from gen_banner import banner
+
+# BuiltinOperator values of the TFLite schema and the matching
+# MicroMutableOpResolver methods
+builtin_ops = {
+    0: 'Add',
+    1: 'AveragePool2D',
+    2: 'Concatenation',
+    3: 'Conv2D',
+    4: 'DepthwiseConv2D',
+    6: 'Dequantize',
+    8: 'Floor',
+    9: 'FullyConnected',
+    14: 'Logistic',
+    17: 'MaxPool2D',
+    18: 'Mul',
+    19: 'Relu',
+    21: 'Relu6',
+    22: 'Reshape',
+    25: 'Softmax',
+    28: 'Tanh',
+    34: 'Pad',
+    40: 'Mean',
+    41: 'Sub',
+    42: 'Div',
+    43: 'Squeeze',
+    45: 'StridedSlice',
+    47: 'Exp',
+    49: 'Split',
+    50: 'LogSoftmax',
+    53: 'Cast',
+    55: 'Maximum',
+    56: 'ArgMax',
+    57: 'Minimum',
+    114: 'Quantize',
+}
+
+# Custom operators of the TFLM signal library
+custom_ops = {
+    'SignalWindow': 'Window',
+    'SignalRfft': 'Rfft',
+    'SignalFftAutoScale': 'FftAutoScale',
+    'SignalEnergy': 'Energy',
+    'SignalFilterBank': 'FilterBank',
+    'SignalFilterBankSquareRoot': 'FilterBankSquareRoot',
+    'SignalFilterBankSpectralSubtraction': 'FilterBankSpectralSubtraction',
+    'SignalPCAN': 'PCAN',
+    'SignalFilterBankLog': 'FilterBankLog',
+    'SignalOverlapAdd': 'OverlapAdd',
+    'SignalStacker': 'Stacker',
+    'SignalFramer': 'Framer',
+    'SignalDelay': 'Delay',
+}
+
+# Operators whose kernel can be replaced by defining OP_RESOLVER_<OP> to a
+# TFLMRegistration before including the header
+overridable_ops = {
+    'Conv2D': 'CONV_2D',
+    'DepthwiseConv2D': 'DEPTHWISE_CONV_2D',
+    'FullyConnected': 'FULLY_CONNECTED',
+    'Softmax': 'SOFTMAX',
+}
+
+BUILTIN_CUSTOM = 32
+
+class FlatBuffer:
+    def __init__(self, data):
+        self.data = data
+
+    def u16(self, pos):
+        return struct.unpack_from('<H', self.data, pos)[0]
+
+    def u32(self, pos):
+        return struct.unpack_from('<I', self.data, pos)[0]
+
+    def i32(self, pos):
+        return struct.unpack_from('<i', self.data, pos)[0]
+
+    def i8(self, pos):
+        return struct.unpack_from('<b', self.data, pos)[0]
+
+    def root(self):
+        return self.u32(0)
+
+    def field(self, table, index):
+        vtable = table - self.i32(table)
+        if 4 + 2*index >= self.u16(vtable):
+            return None
+        offset = self.u16(vtable + 4 + 2*index)
+        return table + offset if offset else None
+
+    def table(self, pos):
+        return pos + self.u32(pos)
+
+    def vector(self, pos):
+        vec = pos + self.u32(pos)
+        return [vec + 4 + 4*i for i in range(self.u32(vec))]
+
+    def string(self, pos):
+        pos += self.u32(pos)
+        return self.data[pos + 4:pos + 4 + self.u32(pos)].decode()
+
+def load_model(path):
+    with open(path, 'rb') as file:
+        data = file.read()
+
+    if path.endswith('.tflite'):
+        return data
+
+    # xxd -i style header, the first array is the model
+    text = data.decode()
+    body = text[text.index('{') + 1:text.index('}')]
+    return bytes(int(x, 0) for x in re.findall(r'0x[0-9a-fA-F]+', body))
+
+def model_ops(path):
+    fb = FlatBuffer(load_model(path))
+
+    if fb.data[4:8] != b'TFL3':
+        raise ValueError(f'{path}: not a TFLite model')
+
+    model = fb.root()
+
+    # Model.operator_codes
+    codes = []
+    for entry in fb.vector(fb.field(model, 1)):
+        code = fb.table(entry)
+        deprecated = fb.field(code, 0)
+        custom = fb.field(code, 1)
+        builtin = fb.field(code, 3)
+
+        op = max(fb.i8(deprecated) if deprecated else 0,
+                 fb.i32(builtin) if builtin else 0)
+
+        if op == BUILTIN_CUSTOM:
+            name = fb.string(custom)
+            if name not in custom_ops:
+                raise ValueError(f'{path}: unsupported custom op {name}')
+            codes.append(custom_ops[name])
+        else:
+            if op not in builtin_ops:
+                raise ValueError(f'{path}: unsupported builtin op {op}')
+            codes.append(builtin_ops[op])
+
+    # Model.subgraphs[].operators[].opcode_index, keep the ops in use only
+    used = []
+    for entry in fb.vector(fb.field(model, 2)):
+        subgraph = fb.table(entry)
+        operators = fb.field(subgraph, 3)
+        for op_entry in fb.vector(operators) if operators else []:
+            index = fb.field(fb.table(op_entry), 0)
+            op = codes[fb.u32(index) if index else 0]
+            if op not in used:
+                used.append(op)
+
+    return used
+
+def write_header(models, out):
+    lines = []
+    put = lines.append
+
+    names = ', '.join(os.path.basename(path) for _, path, _ in models)
+    put(banner('TFLM op resolvers', 'gen_op_resolver.py',
+        [('Models', names)]))
+    put('')
+    put('#pragma once')
+    put('')
+    put('#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"')
+    put('')
+
+    overridden = sorted({op for _, _, ops in models for op in ops
+                         if op in overridable_ops})
+    for op in overridden:
+        OP = overridable_ops[op]
+        put(f'#ifndef OP_RESOLVER_{OP}')
+        put(f'#define OP_RESOLVER_{OP} tflite::Register_{OP}()')
+        put('#endif')
+        put('')
+
+    for name, path, ops in models:
+        put(f'// {os.path.basename(path)}')
+        put(f'using {name}OpResolver = '
+            f'tflite::MicroMutableOpResolver<{len(ops)}>;')
+        put('')
+        put(f'static inline TfLiteStatus Register{name}Ops('
+            f'{name}OpResolver& resolver) {{')
+        for op in ops:
+            arg = f'OP_RESOLVER_{overridable_ops[op]}' \
+                if op in overridable_ops else ''
+            put(f'  if (resolver.Add{op}({arg}) != kTfLiteOk) '
+                'return kTfLiteError;')
+        put('  return kTfLiteOk;')
+        put('}')
+        put('')
+
+    with open(out, 'w') as file:
+        file.write('\n'.join(lines))
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument('models', type=str, nargs='+', metavar='NAME=MODEL',
+        help='Resolver name and .tflite file or C header of a model.')
+    parser.add_argument('-o', '--output', type=str, required=True,
+        help='Output C++ header file.')
+
+    args = parser.parse_args()
+
+    models = []
+    try:
+        for arg in args.models:
+            name, sep, path = arg.partition('=')
+            if not sep or not name.isidentifier():
+                raise ValueError(f'{arg}: expected NAME=MODEL')
+            models.append((name, path, model_ops(path)))
+    except (OSError, ValueError) as e:
+        print(f'gen_op_resolver.py: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    write_header(models, args.output)
@@ -2,7 +2,9 @@
 """
 gen_ral.py is a command-line tool that generates a C header file for
 the Register Abstraction Layer (RAL) based on a YAML configuration file
-generated by adam.py. This is distinct from the adam.yml file.
+generated by adam.py. This is distinct from the adam.yml file. It can also
+generate a C++ header of compile-time register and field descriptors on top
+of the C one.
 """
 
 import argparse
@@ -31,6 +33,102 @@ header_template = """
  */
 """
 
+cxx_template = """
+#include <cstdint>
+#include <type_traits>
+
+#include "{c_header}"
+
+namespace ral {{
+
+using data_t = uint32_t;
+
+// Register at word Offset of the block Base::base() points at
+template <typename Base, unsigned Offset, bool ReadOnly>
+struct Register {{
+    static constexpr unsigned offset = Offset;
+    static constexpr bool read_only = ReadOnly;
+
+    static ral_data_t *ptr() {{
+        return reinterpret_cast<ral_data_t *>(Base::base()) + Offset;
+    }}
+
+    static data_t read() {{ return *ptr(); }}
+
+    static void write(data_t value) {{
+        static_assert(!ReadOnly, "register is read-only");
+        *ptr() = value;
+    }}
+}};
+
+// Width bits at Pos of Reg
+template <typename Reg, unsigned Pos, unsigned Width>
+struct Field {{
+    using reg = Reg;
+    static constexpr unsigned pos = Pos;
+    static constexpr unsigned width = Width;
+    static constexpr data_t mask =
+        (Width >= 32 ? ~data_t{{0}} : (data_t{{1}} << Width) - 1) << Pos;
+
+    static constexpr data_t encode(data_t value) {{
+        return (value << Pos) & mask;
+    }}
+
+    static data_t read() {{ return (Reg::read() & mask) >> Pos; }}
+}};
+
+namespace detail {{
+
+template <typename First, typename... Fields>
+struct FieldSet {{
+    using reg = typename First::reg;
+    static constexpr bool same_register =
+        (std::is_same_v<typename Fields::reg, reg> && ...);
+    static constexpr data_t mask = (First::mask | ... | Fields::mask);
+    static constexpr bool disjoint =
+        (First::mask + ... + Fields::mask) == mask;
+}};
+
+template <typename... Fields>
+constexpr bool check() {{
+    using F = detail::FieldSet<Fields...>;
+    static_assert(F::same_register, "fields of different registers");
+    static_assert(F::disjoint, "field listed twice");
+    static_assert(!F::reg::read_only, "register is read-only");
+    return true;
+}}
+
+}}  // namespace detail
+
+template <typename Field>
+inline data_t read() {{
+    return Field::read();
+}}
+
+// Stores the fields in one access, the other fields of the register are
+// written as 0
+template <typename... Fields, typename... Values>
+inline void write(Values... values) {{
+    static_assert(sizeof...(Fields) == sizeof...(Values), "one value per field");
+    static_assert(detail::check<Fields...>());
+    using Reg = typename detail::FieldSet<Fields...>::reg;
+    Reg::write((Fields::encode(static_cast<data_t>(values)) | ...));
+}}
+
+// Updates the fields with one load and one store, the other fields of the
+// register keep their value. Event flags cleared by writing 1 are written
+// back as read, use write() on those registers.
+template <typename... Fields, typename... Values>
+inline void modify(Values... values) {{
+    static_assert(sizeof...(Fields) == sizeof...(Values), "one value per field");
+    static_assert(detail::check<Fields...>());
+    using F = detail::FieldSet<Fields...>;
+    using Reg = typename F::reg;
+    Reg::write((Reg::read() & ~F::mask) |
+               (Fields::encode(static_cast<data_t>(values)) | ...));
+}}
+"""
+
 class Field:
     def __init__(self, name=None, size=None):
         self.name = name
@@ -73,12 +171,14 @@ class CodeWritter:
         self.content += num*'\n'
 
 
-def build_syscfg_tgt(name, size=None, en_bar=0, en_ier=0):
+def build_syscfg_tgt(name, size=None, en_bar=0, en_ier=0, en_done=0):
     syscfg_tgt = Struct(name, size)
 
     sr = Register('SR', read_only=True)
     sr.add(Flag(f'P'))
     sr.add(Flag(f'S'))
+    if en_done:
+        sr.add(Flag(f'D'))
     syscfg_tgt.add(sr)
 
     mr = Register('MR')
@@ -107,7 +207,8 @@ def build_syscfg_t(cfg):
     if cfg['en_lpmem']:
         syscfg.add(build_syscfg_tgt('LPMEM'))
     syscfg.add(build_syscfg_tgt('CPU', cfg['no_cpus'], en_bar=1, en_ier=1))
-    syscfg.add(build_syscfg_tgt('DMA', cfg['no_dmas'], en_ier=1))
+    syscfg.add(build_syscfg_tgt('DMA', cfg['no_dmas'], en_bar=1, en_ier=1,
+        en_done=1))
     syscfg.add(build_syscfg_tgt('MEM', cfg['no_mems']))
     
     for lspx in ['lspa', 'lspb']:
@@ -178,15 +279,26 @@ def build_spi_t(cfg):
     sr = Register('SR')
     sr.add(Flag('TBE'))
     sr.add(Flag('RBF'))
+    sr.add(Flag('RWM'))
+    sr.add(Flag('ROV'))
+    sr.add(Flag(None, 4))
+    sr.add(Flag('RXL', 8))
     spi.add(sr)
 
     spi.add(Register('BRR'))
 
     ier = Register('IER')
-    ier.add(Flag('RBFIE'))
     ier.add(Flag('TBEIE'))
+    ier.add(Flag('RBFIE'))
+    ier.add(Flag('RWMIE'))
+    ier.add(Flag('ROVIE'))
     spi.add(ier)
 
+    fcr = Register('FCR')
+    fcr.add(Flag('RXWM', 8))
+    fcr.add(Flag('TTE'))
+    spi.add(fcr)
+
     return spi
 
 
@@ -280,6 +392,33 @@ def build_aes_t(cfg):
     
     aes.add(Register('RESULT',read_only=True))
 
+    # Block FIFOs of the AXI-Lite wrapper (0x08 - 0x0C)
+    aes.add(Register('DIN'))
+    aes.add(Register('DOUT', read_only=True))
+
+    fsr = Register('FSR')
+    fsr.add(Flag('IWM'))     # bit 0: input level at or below IWML
+    fsr.add(Flag('OWM'))     # bit 1: output level at or above OWML
+    fsr.add(Flag('IOV'))     # bit 2: input overrun (W1C)
+    fsr.add(Flag('OUD'))     # bit 3: output underrun (W1C)
+    fsr.add(Flag(None, 4))
+    fsr.add(Flag('IL', 8))   # input level, in blocks
+    fsr.add(Flag('OL', 8))   # output level, in blocks
+    aes.add(fsr)
+
+    fcr = Register('FCR')
+    fcr.add(Flag('IWML', 8))
+    fcr.add(Flag('OWML', 8))
+    fcr.add(Flag('FLUSH'))   # bit 16: empties both FIFOs (write pulse)
+    aes.add(fcr)
+
+    fier = Register('FIER')
+    fier.add(Flag('IWMIE'))
+    fier.add(Flag('OWMIE'))
+    fier.add(Flag('IOVIE'))
+    fier.add(Flag('OUDIE'))
+    aes.add(fier)
+
     return aes
 
 
@@ -390,16 +529,32 @@ def write_struct(struct, cw, typedef=False):
     else:
         cw.put('};')
 
-def write_ral_def(cfg, cw):
-    cw.put('static const ral_t RAL = {')
-    cw.indent += 1
-    
+def write_ral_def(cfg, cw, host=False):
+    # On the host the RAL points at plain memory instead of the memory map.
+    # The storage is raw words, the register structs have const members, and
+    # weak so every translation unit shares the same copy.
+    def ptr(dtype, addr, storage, index=0):
+        if not host:
+            return f'({dtype} *) {ahex(addr, aw)}'
+        return f'({dtype} *) {storage}[{index}]'
+
+    def host_array(dtype, storage, size=1):
+        if host:
+            words = f'sizeof({dtype}) / sizeof(ral_data_t)'
+            host_defs.append(
+                f'ral_data_t {storage}[{size}][{words}] __attribute__((weak));')
+
+    host_defs = []
+    lines = []
+
     if cfg['en_lpmem']:
         addr, end = cfg['mmap_lpmem']
-        cw.put(f'.LPMEM = (ral_data_t *) {ahex(addr, aw)},')
+        host_array('ral_data_t', 'ral_host_lpmem')
+        lines.append((0, f'.LPMEM = {ptr("ral_data_t", addr, "ral_host_lpmem")},'))
 
     addr, end = cfg['mmap_syscfg']
-    cw.put(f'.SYSCFG = (ral_syscfg_t *) {ahex(addr, aw)},')
+    host_array('ral_syscfg_t', 'ral_host_syscfg')
+    lines.append((0, f'.SYSCFG = {ptr("ral_syscfg_t", addr, "ral_host_syscfg")},'))
 
     for lspx in ['lspa', 'lspb']:
         LSPX = lspx.upper()
@@ -407,8 +562,7 @@ def write_ral_def(cfg, cw):
         if not cfg[f'en_{lspx}']:
             continue
 
-        cw.put(f'.{LSPX}' + ' = {')
-        cw.indent += 1
+        lines.append((0, f'.{LSPX}' + ' = {'))
 
         addr, end, inc = cfg[f'mmap_{lspx}']
 
@@ -420,39 +574,151 @@ def write_ral_def(cfg, cw):
             if size <= 0:
                 continue
 
-            cw.put(f'.{PERIPH}' + ' = {')
-            cw.indent += 1
+            storage = f'ral_host_{lspx}_{periph}'
+            host_array(f'ral_{periph}_t', storage, size)
+
+            lines.append((1, f'.{PERIPH}' + ' = {'))
             
             for i in range(size):
-                cw.put(f'(ral_{periph}_t *) {ahex(addr, aw)},')
+                lines.append((2, ptr(f'ral_{periph}_t', addr, storage, i) + ','))
                 addr += inc
 
-            cw.indent -= 1
-            cw.put('},')
+            lines.append((1, '},'))
 
-        cw.indent -= 1
-        cw.put('},')
+        lines.append((0, '},'))
 
     size = cfg[f'no_mems']
 
     if size > 0:
-        cw.put('.MEM = {')
-        cw.indent += 1
+        host_array('ral_data_t', 'ral_host_mem', size)
+
+        lines.append((0, '.MEM = {'))
         
         addr, end, inc = cfg['mmap_mem']
         for i in range(size):
-            cw.put(f'(ral_data_t *) {ahex(addr, aw)},')
+            lines.append((1, ptr('ral_data_t', addr, 'ral_host_mem', i) + ','))
             addr += inc
 
-        cw.indent -= 1
-        cw.put('},')
+        lines.append((0, '},'))
     
     addr, end = cfg['mmap_aes']
-    cw.put(f'.AES = (ral_aes_t *) {ahex(addr, aw)},')
+    host_array('ral_aes_t', 'ral_host_aes')
+    lines.append((0, f'.AES = {ptr("ral_aes_t", addr, "ral_host_aes")},'))
+
+    if host_defs:
+        for line in host_defs:
+            cw.put(line)
+        cw.skip()
+
+    cw.put('static const ral_t RAL = {')
+    cw.indent += 1
+
+    for indent, line in lines:
+        cw.indent += indent
+        cw.put(line)
+        cw.indent -= indent
 
     cw.indent -= 1
     cw.put('};')
 
+# ral_spi_t is Spi
+def cxx_name(struct):
+    return struct.name.removeprefix('ral_').removesuffix('_t').capitalize()
+
+# Block of registers as a class template over the base address, with one
+# descriptor per register and one per named field. Registers are one word
+# each, or one per element for arrays.
+def write_cxx_block(struct, cw):
+    cw.put('template <typename Base>')
+    cw.put(f'struct {cxx_name(struct)} {"{"}')
+    cw.indent += 1
+
+    offset = 0
+    for register in struct.items:
+        if not isinstance(register, Register):
+            raise ValueError(f'{struct.name}: not a register block')
+
+        if register.name and not register.name.startswith('reserved'):
+            read_only = 'true' if register.read_only else 'false'
+            base = f'Register<Base, {offset}, {read_only}>'
+
+            fields = [f for f in register.items if f.name]
+            if fields:
+                cw.put(f'struct {register.name} : {base} {"{"}')
+                cw.indent += 1
+                pos = 0
+                for flag in register.items:
+                    if flag.name:
+                        cw.put(f'using {flag.name} = '
+                               f'Field<{register.name}, {pos}, {flag.size}>;')
+                    pos += flag.size
+                cw.indent -= 1
+                cw.put('};')
+            else:
+                cw.put(f'struct {register.name} : {base} {"{}"};')
+
+        offset += register.size or 1
+
+    cw.indent -= 1
+    cw.put('};')
+
+def write_cxx_instance(cw, name, dtype, block, ral, size=None):
+    if size is None:
+        cw.put(f'struct {name}_base {"{"}')
+        cw.indent += 1
+        cw.put(f'static {dtype} *base() {"{"} return {ral}; {"}"}')
+        cw.indent -= 1
+        cw.put('};')
+        cw.put(f'using {name} = {block}<{name}_base>;')
+        return
+
+    cw.put('template <unsigned N>')
+    cw.put(f'struct {name}_base {"{"}')
+    cw.indent += 1
+    cw.put(f'static_assert(N < {size}, "no such {name}");')
+    cw.put(f'static {dtype} *base() {"{"} return {ral}[N]; {"}"}')
+    cw.indent -= 1
+    cw.put('};')
+    cw.put('template <unsigned N>')
+    cw.put(f'using {name} = {block}<{name}_base<N>>;')
+
+def write_cxx(cfg, blocks, header, c_header, path):
+    cw = CodeWritter()
+    cw.put(header)
+    cw.skip()
+    cw.put('#pragma once')
+    cw.put(cxx_template.rstrip().format(c_header=c_header))
+    cw.skip()
+
+    for block in blocks:
+        write_cxx_block(block, cw)
+        cw.skip()
+
+    for lspx in ['lspa', 'lspb']:
+        LSPX = lspx.upper()
+        if not cfg[f'en_{lspx}']:
+            continue
+
+        cw.put(f'namespace {LSPX} {"{"}')
+        cw.skip()
+        for periph in ['gpio', 'spi', 'timer', 'uart']:
+            size = cfg[f'no_{lspx}_{periph}s']
+            if size <= 0:
+                continue
+            PERIPH = periph.upper()
+            write_cxx_instance(cw, PERIPH, f'ral_{periph}_t', periph.capitalize(),
+                               f'RAL.{LSPX}.{PERIPH}', size)
+            cw.skip()
+        cw.put(f'{"}"}  // namespace {LSPX}')
+        cw.skip()
+
+    write_cxx_instance(cw, 'AES', 'ral_aes_t', 'Aes', 'RAL.AES')
+    cw.skip()
+    cw.put('}  // namespace ral')
+
+    with open(path, 'w') as file:
+        file.write(cw.content)
+
 def get_git_info():
     cwd = os.path.dirname(os.path.abspath(__file__))
     
@@ -489,6 +755,10 @@ if __name__ == '__main__':
         help='Output C header file.')
     parser.add_argument('-t', '--target', type=str,
         help='The ADAM target.')  
+    parser.add_argument('--host', action='store_true',
+        help='Back the RAL with plain memory, for host builds.')
+    parser.add_argument('--cxx', type=str,
+        help='Also output the C++ header of register descriptors.')
 
     args = parser.parse_args()
 
@@ -512,12 +782,13 @@ if __name__ == '__main__':
     branch, commit = get_git_info()
     target = args.target
 
-    cw.put(header_template.strip().format(
+    header = header_template.strip().format(
         date=date,
         branch=branch,
         commit=commit,
         target=target
-    ))
+    )
+    cw.put(header)
     cw.skip()
     
     cw.put(f'#pragma once')
@@ -541,7 +812,12 @@ if __name__ == '__main__':
         write_struct(typedef, cw, typedef=True)
         cw.skip(1)
 
-    write_ral_def(cfg, cw)
+    write_ral_def(cfg, cw, args.host)
 
     with open(args.output, 'w') as file:
-        file.write(cw.content)
\ No newline at end of file
+        file.write(cw.content)
+
+    # The syscfg targets and the RAL itself are left to the C header
+    if args.cxx:
+        write_cxx(cfg, typedefs[1:-1], header,
+                  os.path.basename(args.output), args.cxx)
\ No newline at end of file
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+kws_bench.py is a command-line tool that checks the report of the KWS
+benchmark (CFG_BENCHMARK) against a baseline. It reads the bench,... lines
+from a UART log, and the profile,... lines of CFG_PROFILER if present, saves
+them as a JSON baseline or compares them with one. Cycle counts may grow by
+at most the tolerance, the detected keywords must match exactly. The exit
+status is 1 on a regression.
+"""
+
+import argparse
+import json
+import sys
+
+# Metrics compared with the tolerance, larger is worse
+def is_cost(key):
+    return key.endswith('_cycles') or key.endswith('_max') or \
+        key in ('elapsed_cycles', 'wakeups', 'overruns')
+
+def parse_log(lines):
+    metrics = {}
+    results = []
+    profile = {}
+    begin = end = False
+
+    for line in lines:
+        fields = line.strip().split(',')
+        if fields[0] == 'bench' and len(fields) >= 2:
+            if fields[1] == 'begin':
+                # keep the last report of the log
+                metrics, results, begin, end = {}, [], True, False
+            elif fields[1] == 'end':
+                end = True
+            elif fields[1] == 'result' and len(fields) == 4:
+                results.append([int(fields[2]), fields[3]])
+            elif len(fields) == 3:
+                metrics[fields[1]] = int(fields[2])
+        elif fields[0] == 'profile' and len(fields) in (5, 6):
+            profile[f'{fields[1]}/{fields[2]}'] = int(fields[4])
+            if len(fields) == 6:
+                profile[f'{fields[1]}/{fields[2]}/imiss'] = int(fields[5])
+
+    if not begin or not end:
+        raise ValueError('no complete bench report in the log')
+
+    return {'metrics': metrics, 'results': results, 'profile': profile}
+
+def compare(report, baseline, tolerance):
+    failures = []
+
+    def check(name, new, old):
+        if old is None or new is None:
+            return
+        limit = old * (1 + tolerance)
+        status = 'FAIL' if new > limit else 'ok'
+        delta = (new - old) / old * 100 if old else 0
+        print(f'{status:4} {name:32} {old:>12} {new:>12} {delta:+7.1f}%')
+        if new > limit:
+            failures.append(name)
+
+    for key, old in baseline['metrics'].items():
+        if is_cost(key):
+            check(key, report['metrics'].get(key), old)
+
+    for key, old in baseline.get('profile', {}).items():
+        check(f'profile/{key}', report['profile'].get(key), old)
+
+    if report['results'] != baseline['results']:
+        print(f'FAIL results: expected {baseline["results"]}, '
+              f'got {report["results"]}')
+        failures.append('results')
+
+    return failures
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument('log', type=str, nargs='?', default='-',
+        help='UART log of the benchmark run, stdin if omitted.')
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument('-s', '--save', type=str, metavar='BASELINE',
+        help='Save the report as a JSON baseline.')
+    group.add_argument('-b', '--baseline', type=str,
+        help='Compare the report with a JSON baseline.')
+    parser.add_argument('-t', '--tolerance', type=float, default=5.0,
+        help='Allowed growth of cycle counts in percent.')
+
+    args = parser.parse_args()
+
+    try:
+        if args.log == '-':
+            report = parse_log(sys.stdin)
+        else:
+            with open(args.log) as file:
+                report = parse_log(file)
+
+        if args.save:
+            with open(args.save, 'w') as file:
+                json.dump(report, file, indent=2)
+            sys.exit(0)
+
+        with open(args.baseline) as file:
+            baseline = json.load(file)
+    except (OSError, ValueError) as e:
+        print(f'kws_bench.py: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    failures = compare(report, baseline, args.tolerance / 100)
+    if failures:
+        print(f'kws_bench.py: {len(failures)} regression(s)', file=sys.stderr)
+        sys.exit(1)
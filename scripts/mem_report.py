@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""
+mem_report.py is a command-line tool that reports where a program landed in
+the ADAM memories from the map file of the GNU linker. It prints the usage
+of every memory region, the largest input sections of each one and, for
+the symbols or sections matching the given patterns, the region they were
+placed in (run address) and loaded from (load address).
+"""
+
+import argparse
+import os
+import re
+import sys
+
+HEX = r'0x[0-9a-fA-F]+'
+
+class Region:
+    def __init__(self, name, origin, length):
+        self.name = name
+        self.origin = origin
+        self.length = length
+        self.used = 0
+        self.inputs = []
+
+    def contains(self, addr):
+        return self.origin <= addr < self.origin + self.length
+
+class Input:
+    def __init__(self, section, addr, size, obj, load):
+        self.section = section
+        self.addr = addr
+        self.size = size
+        self.obj = os.path.basename(obj)
+        self.load = load
+        self.symbols = []
+
+def parse_map(path):
+    with open(path) as file:
+        lines = file.read().splitlines()
+
+    regions = []
+    inputs = []
+
+    # Memory Configuration
+    i = 0
+    while i < len(lines) and not lines[i].startswith('Memory Configuration'):
+        i += 1
+    for line in lines[i + 1:]:
+        if line.startswith('Linker script and memory map'):
+            break
+        m = re.match(rf'(\S+)\s+({HEX})\s+({HEX})', line)
+        if m and m.group(1) != '*default*':
+            regions.append(Region(m.group(1), int(m.group(2), 16),
+                                  int(m.group(3), 16)))
+
+    if not regions:
+        raise ValueError(f'{path}: no memory configuration')
+
+    # Output sections start at column 0, input sections at column 1 and
+    # symbols are an address followed by a name. Long names wrap the rest
+    # of the line to the next one.
+    offset = 0
+    pending = None
+    for line in lines[i:]:
+        if pending is not None:
+            line = pending + ' ' + line.strip()
+            pending = None
+
+        m = re.match(r'(\.\S+|COMMON)$', line.strip())
+        if m and line[:1] in ('.', ' ') and not line.startswith('  '):
+            pending = line.rstrip()
+            continue
+
+        m = re.match(rf'(\.\S+)\s+({HEX})\s+({HEX})(?:\s+load address\s+'
+                     rf'({HEX}))?', line)
+        if m:
+            # offset between load and run addresses of the output section
+            vma = int(m.group(2), 16)
+            offset = int(m.group(4), 16) - vma if m.group(4) else 0
+            continue
+
+        m = re.match(rf' (\S+)\s+({HEX})\s+({HEX})\s+(.+)$', line)
+        if m:
+            addr = int(m.group(2), 16)
+            size = int(m.group(3), 16)
+            # zero-initialized sections are not loaded
+            nobits = 'bss' in m.group(1) or m.group(1) == 'COMMON'
+            if size:
+                inputs.append(Input(m.group(1), addr, size, m.group(4),
+                                    None if nobits else addr + offset))
+            continue
+
+        m = re.match(rf'\s+({HEX})\s+([A-Za-z_.$][\w.$]*)$', line)
+        if m and inputs:
+            addr = int(m.group(1), 16)
+            last = inputs[-1]
+            if last.addr <= addr < last.addr + last.size:
+                last.symbols.append(m.group(2))
+
+    for entry in inputs:
+        for region in regions:
+            if region.contains(entry.addr):
+                region.used += entry.size
+                region.inputs.append(entry)
+                break
+
+    return regions, inputs
+
+def region_of(regions, addr):
+    if addr is None:
+        return '-'
+    for region in regions:
+        if region.contains(addr):
+            return region.name
+    return '-'
+
+def report(regions, inputs, top, patterns):
+    print(f'{"region":8} {"origin":>10} {"used":>8} {"size":>8} {"use":>6}')
+    for region in regions:
+        if region.used == 0:
+            continue
+        percent = region.used / region.length * 100 if region.length else 0
+        print(f'{region.name:8} {region.origin:#010x} {region.used:8} '
+              f'{region.length:8} {percent:5.1f}%')
+
+    for region in regions:
+        if not region.inputs or top == 0:
+            continue
+        print()
+        print(f'{region.name}, largest input sections:')
+        for entry in sorted(region.inputs, key=lambda e: -e.size)[:top]:
+            print(f'  {entry.size:8}  {entry.section:40} {entry.obj}')
+
+    if patterns:
+        print()
+        print(f'{"match":40} {"size":>8} {"run":>6} {"load":>6}')
+        for entry in inputs:
+            # static symbols are not listed, match the object file too
+            where = f'{entry.obj}({entry.section})'
+            names = [where] + entry.symbols
+            if not any(p.search(n) for p in patterns for n in names):
+                continue
+            name = entry.symbols[0] if entry.symbols else where
+            print(f'{name:40} {entry.size:8} '
+                  f'{region_of(regions, entry.addr):>6} '
+                  f'{region_of(regions, entry.load):>6}')
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__.strip())
+    parser.add_argument('map', type=str,
+        help='Map file of the GNU linker (-Wl,-Map=...).')
+    parser.add_argument('-m', '--match', type=str, action='append',
+        default=[], metavar='REGEX',
+        help='Report the placement of matching symbols or sections.')
+    parser.add_argument('-n', '--top', type=int, default=8,
+        help='Number of input sections listed per region.')
+
+    args = parser.parse_args()
+
+    try:
+        patterns = [re.compile(p) for p in args.match]
+        regions, inputs = parse_map(args.map)
+    except (OSError, ValueError, re.error) as e:
+        print(f'mem_report.py: {e}', file=sys.stderr)
+        sys.exit(1)
+
+    report(regions, inputs, args.top, patterns)
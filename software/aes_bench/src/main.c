@@ -0,0 +1,220 @@
+#include "system.h"
+
+// AES throughput. Every run ciphers the same buffer and prints, on UART[0]:
+//   aes,<run>,<blocks>,<cycles>,<bytes per cycle>
+// The single run is the one block API, the others the streams, through the
+// block FIFOs but for CBC encryption. The streams are then checked against
+// the NIST SP 800-38A AES-128 vectors:
+//   aes,check,<mode>,<pass|FAIL>
+
+#define BLOCKS 32
+
+static const uint32_t key[4] = {
+    0x2b7e1516, 0x28aed2a6, 0xabf71588, 0x09cf4f3c,
+};
+
+// SP 800-38A F.1.1, F.2.1 and F.5.1
+static const uint32_t vector_in[16] = {
+    0x6bc1bee2, 0x2e409f96, 0xe93d7e11, 0x7393172a,
+    0xae2d8a57, 0x1e03ac9c, 0x9eb76fac, 0x45af8e51,
+    0x30c81c46, 0xa35ce411, 0xe5fbc119, 0x1a0a52ef,
+    0xf69f2445, 0xdf4f9b17, 0xad2b417b, 0xe66c3710,
+};
+
+static const uint32_t vector_ecb[16] = {
+    0x3ad77bb4, 0x0d7a3660, 0xa89ecaf3, 0x2466ef97,
+    0xf5d3d585, 0x03b9699d, 0xe785895a, 0x96fdbaaf,
+    0x43b1cd7f, 0x598ece23, 0x881b00e3, 0xed030688,
+    0x7b0c785e, 0x27e8ad3f, 0x82232071, 0x04725dd4,
+};
+
+static const uint32_t vector_cbc_iv[4] = {
+    0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f,
+};
+
+static const uint32_t vector_cbc[16] = {
+    0x7649abac, 0x8119b246, 0xcee98e9b, 0x12e9197d,
+    0x5086cb9b, 0x507219ee, 0x95db113a, 0x917678b2,
+    0x73bed6b8, 0xe3c1743b, 0x7116e69e, 0x22229516,
+    0x3ff1caa1, 0x681fac09, 0x120eca30, 0x7586e1a7,
+};
+
+static const uint32_t vector_ctr_iv[4] = {
+    0xf0f1f2f3, 0xf4f5f6f7, 0xf8f9fafb, 0xfcfdfeff,
+};
+
+static const uint32_t vector_ctr[16] = {
+    0x874d6191, 0xb620e326, 0x1bef6864, 0x990db6ce,
+    0x9806f66b, 0x7970fdff, 0x8617187b, 0xb9fffdff,
+    0x5ae4df3e, 0xdbd5d35e, 0x5b4f0902, 0x0db03eab,
+    0x1e031dda, 0x2fbe03d1, 0x792170a0, 0xf3009cee,
+};
+
+static uint32_t plain[4 * BLOCKS];
+static uint32_t cipher[4 * BLOCKS];
+
+void __attribute__((interrupt)) default_handler(void)
+{
+    aes_stream_irq();
+}
+
+static void put_str(const char *s)
+{
+    while (*s)
+        uart_putc(RAL.LSPA.UART[0], *s++);
+}
+
+static void put_u32(uint32_t x)
+{
+    char buf[11];
+    int i = sizeof(buf) - 1;
+
+    buf[i] = 0;
+    do {
+        buf[--i] = '0' + x % 10;
+        x /= 10;
+    } while (x);
+    put_str(&buf[i]);
+}
+
+// Free running at the system clock
+static void cycles_init(void)
+{
+    RAL.SYSCFG->LSPA.TIMER[1].MR = 1;
+    while (RAL.SYSCFG->LSPA.TIMER[1].MR);
+
+    RAL.LSPA.TIMER[1]->PR = 0;
+    RAL.LSPA.TIMER[1]->VR = 0;
+    RAL.LSPA.TIMER[1]->ARR = ~0;
+    RAL.LSPA.TIMER[1]->IER = 0;
+    RAL.LSPA.TIMER[1]->CR = 1;
+}
+
+static uint32_t cycles(void)
+{
+    return RAL.LSPA.TIMER[1]->VR;
+}
+
+static void report(const char *run, uint32_t elapsed)
+{
+    // Bytes per cycle with 3 decimals
+    uint32_t milli = (uint32_t) ((uint64_t) 16 * BLOCKS * 1000 / elapsed);
+
+    put_str("aes,");
+    put_str(run);
+    put_str(",");
+    put_u32(BLOCKS);
+    put_str(",");
+    put_u32(elapsed);
+    put_str(",");
+    put_u32(milli / 1000);
+    put_str(".");
+    put_u32(milli / 100 % 10);
+    put_u32(milli / 10 % 10);
+    put_u32(milli % 10);
+    put_str("\r\n");
+}
+
+static void check(const char *mode, const uint32_t *out, const uint32_t *ref)
+{
+    int pass = 1;
+
+    for (int i = 0; i < 16; i++)
+        if (out[i] != ref[i])
+            pass = 0;
+
+    put_str("aes,check,");
+    put_str(mode);
+    put_str(pass ? ",pass\r\n" : ",FAIL\r\n");
+}
+
+static void bench_single(void)
+{
+    uint32_t t0 = cycles();
+
+    for (int i = 0; i < BLOCKS; i++) {
+        aes_write_block(&plain[4 * i]);
+        aes_start();
+        while (!aes_is_done());
+        aes_read_result(&cipher[4 * i]);
+    }
+
+    report("single", cycles() - t0);
+}
+
+static void bench_stream(const char *run, uint8_t mode)
+{
+    uint32_t iv[4] = {0};
+    uint32_t t0 = cycles();
+
+    aes_crypt_stream(mode, iv, plain, cipher, BLOCKS);
+
+    report(run, cycles() - t0);
+}
+
+static void bench_stream_irq(void)
+{
+    uint32_t iv[4] = {0};
+    uint32_t t0 = cycles();
+
+    aes_crypt_stream_irq(AES_MODE_CTR, iv, plain, cipher, BLOCKS, NULL, NULL);
+    while (aes_stream_busy());
+
+    report("ctr_irq", cycles() - t0);
+}
+
+static void check_streams(void)
+{
+    uint32_t iv[4];
+
+    aes_crypt_stream(AES_MODE_ECB, NULL, vector_in, cipher, 4);
+    check("ecb", cipher, vector_ecb);
+
+    for (int i = 0; i < 4; i++)
+        iv[i] = vector_cbc_iv[i];
+    aes_crypt_stream(AES_MODE_CBC, iv, vector_in, cipher, 4);
+    check("cbc", cipher, vector_cbc);
+
+    // In two calls, the counter carries over
+    for (int i = 0; i < 4; i++)
+        iv[i] = vector_ctr_iv[i];
+    aes_crypt_stream(AES_MODE_CTR, iv, vector_in, cipher, 1);
+    aes_crypt_stream(AES_MODE_CTR, iv, &vector_in[4], &cipher[4], 3);
+    check("ctr", cipher, vector_ctr);
+
+    for (int i = 0; i < 4; i++)
+        iv[i] = vector_ctr_iv[i];
+    aes_crypt_stream_irq(AES_MODE_CTR, iv, vector_in, cipher, 4, NULL, NULL);
+    while (aes_stream_busy());
+    check("ctr_irq", cipher, vector_ctr);
+}
+
+int main()
+{
+    RAL.SYSCFG->LSPA.UART[0].MR = 1;
+    while (RAL.SYSCFG->LSPA.UART[0].MR);
+    uart_init(RAL.LSPA.UART[0], 115200);
+
+    cycles_init();
+
+    // External interrupts are enabled by the startup code
+    RAL.SYSCFG->CPU[0].IER = ~0;
+
+    for (int i = 0; i < 4 * BLOCKS; i++)
+        plain[i] = 0x9e3779b9 * (i + 1);
+
+    aes_init();
+    aes_config(AES_ENCRYPT, AES_KEYLEN_128);
+    aes_write_key((uint32_t *) key, AES_KEYLEN_128);
+
+    bench_single();
+    bench_stream("ecb", AES_MODE_ECB);
+    bench_stream("cbc", AES_MODE_CBC);
+    bench_stream("ctr", AES_MODE_CTR);
+    bench_stream_irq();
+
+    check_streams();
+
+    while (1)
+        _WFI();
+}
@@ -1,6 +1,11 @@
 set(TFLM_SRC_DIR ${ADAM_LIBS_DIR}/tflite-micro)
 set(TFLM_TREE_DIR ${CMAKE_BINARY_DIR}/tflm-tree)
 
+# TFLM makefile target the tree is generated for, host builds use linux
+if(NOT DEFINED TFLM_TARGET)
+  set(TFLM_TARGET riscv32_generic)
+endif()
+
 if(EXISTS ${TFLM_TREE_DIR}/tensorflow/lite/micro/micro_interpreter.h)
   message(WARNING
     "TFLM tree found; generation skipped. "
@@ -11,7 +16,7 @@ else()
   execute_process(
     COMMAND ${Python3_EXECUTABLE}
             tensorflow/lite/micro/tools/project_generation/create_tflm_tree.py
-            --makefile_options=TARGET=riscv32_generic
+            --makefile_options=TARGET=${TFLM_TARGET}
             ${TFLM_TREE_DIR}
     WORKING_DIRECTORY ${TFLM_SRC_DIR}
     RESULT_VARIABLE gen_result
@@ -62,4 +67,6 @@ target_include_directories(tflm PUBLIC
   ${TFLM_TREE_DIR}/third_party/ruy
 )
 
-target_link_libraries(tflm PRIVATE riscv_stdlib rv32imc)
+if(TARGET riscv_stdlib)
+  target_link_libraries(tflm PRIVATE riscv_stdlib rv32imc)
+endif()
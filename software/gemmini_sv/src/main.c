@@ -1,43 +1,9 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "gmsv.h"
 #include "system.h"
 
-#define CSR_WRITE(CSR, VALUE) \
-    asm volatile ("csrrw x0, " #CSR ", %0" :: "r"(VALUE))
-
-#define MVIN(RS1, RS2, CFG) \
-    asm volatile ( \
-        ".insn r CUSTOM_0, 0, %c0, x0, %1, %2" :: \
-        "i"(((CFG) & 0x3) << 5), "r"(RS1), "r"(RS2))
-
-#define MVOUT(RS1, RS2, CFG) \
-    asm volatile ( \
-        ".insn r CUSTOM_0, 0, %c0, x0, %1, %2" :: \
-        "i"((((CFG) & 0x3) << 5) | 1), "r"(RS1), "r"(RS2))
-
-#define FENCE(CFG) \
-    asm volatile ( \
-        ".insn r CUSTOM_0, 0, %c0, x0, x0, x0" :: \
-        "i"((((CFG) & 0x3) << 5) | 1))
-
-#define MATMUL_PRELOAD(RS1, RS2, CFG) \
-    asm volatile ( \
-        ".insn r CUSTOM_0, 1, %c0, x0, %1, %2" :: \
-        "i"(((CFG) & 0x3) << 5), "r"(RS1), "r"(RS2))
-
-#define MATMUL_COMPUTE(RS1, RS2, END, CFG) \
-    asm volatile ( \
-        ".insn r CUSTOM_0, 1, %c0, x0, %1, %2" :: \
-        "i"(((((CFG) & 0x3) << 5) | (((END) & 0x1) << 2) | 1)), \
-        "r"(RS1), "r"(RS2))
-
-#define MATMUL(MAT_A, MAT_B, MAT_C, MAT_R, CFG) \
-    do { \
-        MATMUL_PRELOAD(MAT_C, MAT_R, CFG); \
-        MATMUL_COMPUTE(MAT_A, MAT_B, 1, CFG); \
-    } while (0)
-
 static void print_matrix(uint8_t mat[4][4]) {
     printf("{\n");
     for (int i = 0; i < 4; i++) {
@@ -126,10 +92,10 @@ int main() {
     hw_init();
     uart_init(RAL.LSPA.UART[0], SYSTEM_CLOCK/2);
 
-    CSR_WRITE(0x800, 0);
-    CSR_WRITE(0x801, 4);
-    CSR_WRITE(0x802, 4);
-    CSR_WRITE(0x803, 4);
+    CSR_WRITE(GMSV_CSR_CTRL, 0);
+    CSR_WRITE(GMSV_CSR_STRIDE(0), 4);
+    CSR_WRITE(GMSV_CSR_STRIDE(1), 4);
+    CSR_WRITE(GMSV_CSR_STRIDE(2), 4);
 
     // printf("Hello, World!\n");
 
@@ -25,6 +25,28 @@
 // Interrupt Enable Register bits
 #define AES_IER_DONEIE_BIT     0
 
+// Block FIFOs of the AXI-Lite wrapper (FIFO_DEPTH of adam_axil_aes)
+#define AES_FIFO_DEPTH         8
+
+// FIFO Status Register bits
+#define AES_FSR_IWM_BIT        0
+#define AES_FSR_OWM_BIT        1
+#define AES_FSR_IOV_BIT        2
+#define AES_FSR_OUD_BIT        3
+#define AES_FSR_IL_SHIFT       8
+#define AES_FSR_OL_SHIFT       16
+
+// FIFO Control Register fields
+#define AES_FCR_IWML_SHIFT     0
+#define AES_FCR_OWML_SHIFT     8
+#define AES_FCR_FLUSH_BIT      16
+
+// FIFO Interrupt Enable Register bits
+#define AES_FIER_IWMIE_BIT     0
+#define AES_FIER_OWMIE_BIT     1
+#define AES_FIER_IOVIE_BIT     2
+#define AES_FIER_OUDIE_BIT     3
+
 // Function prototype
 void aes_init(void);
 void aes_config(uint8_t encrypt, uint8_t keylen);
@@ -39,5 +61,37 @@ void aes_read_result(uint32_t *result);
 uint32_t aes_read_status(void);
 bool aes_is_done(void);
 uint32_t aes_read_events(void);
+void aes_fifo_flush(void);
+
+// Stream modes
+#define AES_MODE_ECB     0
+#define AES_MODE_CBC     1
+#define AES_MODE_CTR     2
+
+// Called from the AES interrupt once the stream is done
+typedef void (*aes_stream_cb_t)(void *arg);
+
+// Multi-block streams. Blocks are 4 words in the order of BLOCK and RESULT,
+// the first one most significant. The key is written beforehand with
+// aes_write_key() and stays expanded in the core from one block and one
+// stream to the next. iv holds the chaining value (CBC) or the counter
+// (CTR), it is updated so that the next call continues the stream. The
+// direction is the one of aes_config(), CTR always enciphers. in and out may
+// be the same buffer. ECB and CTR go through the block FIFOs with several
+// blocks in flight in the core, the key may then only change between
+// streams. Their interrupt variant runs on the output watermark
+// interrupt instead of the done one.
+//
+// Only encryption is supported in ECB and CBC: the pipelined core has no
+// decipher datapath and ignores the aes_config() direction, so both return
+// -1 after aes_config(AES_DECRYPT, ...). CTR decrypts with the forward
+// cipher and works either way.
+int aes_crypt_stream(uint8_t mode, uint32_t *iv, const uint32_t *in,
+                     uint32_t *out, uint32_t nblocks);
+int aes_crypt_stream_irq(uint8_t mode, uint32_t *iv, const uint32_t *in,
+                         uint32_t *out, uint32_t nblocks,
+                         aes_stream_cb_t callback, void *arg);
+void aes_stream_irq(void);
+bool aes_stream_busy(void);
 
 #endif // __AES_H__
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#include "adam_ral.h"
+#include "types.h"
+
+// Descriptor CTRL bits
+#define DMA_CTRL_SINC   (1u << 0)
+#define DMA_CTRL_DINC   (1u << 1)
+#define DMA_CTRL_PACED  (1u << 2)
+#define DMA_CTRL_ERR    (1u << 30)
+#define DMA_CTRL_DONE   (1u << 31)
+
+// Maestro actions of the syscfg MR register
+#define DMA_MR_RESUME   1
+#define DMA_MR_STOP     3
+#define DMA_MR_RESET    4
+
+// In-memory descriptor, read by the DMA and written back on completion
+typedef struct dma_desc {
+    volatile uint32_t src;
+    volatile uint32_t dst;
+    volatile uint32_t count;
+    volatile uint32_t ctrl;
+    volatile struct dma_desc *next;
+} dma_desc_t;
+
+void dma_desc_init(dma_desc_t *desc, const volatile void *src,
+                   volatile void *dst, uint32_t count, uint32_t ctrl,
+                   dma_desc_t *next);
+void dma_start(int dma, dma_desc_t *desc, uint32_t req_mask);
+void dma_stop(int dma);
+bool dma_is_done(dma_desc_t *desc);
+bool dma_has_error(dma_desc_t *desc);
+int dma_wait(int dma, dma_desc_t *desc);
+int dma_memcpy(int dma, void *dst, const void *src, uint32_t words);
+
+#endif // __DMA_H__
@@ -0,0 +1,50 @@
+#ifndef __GMSV_H__
+#define __GMSV_H__
+
+// Gemmini-SV systolic array, driven through the CV32E40X eXtension
+// interface (adam_core_gmsv). The array works on GMSV_DIM x GMSV_DIM tiles,
+// scratchpad addresses are in rows and a tile spans GMSV_DIM rows.
+
+#define GMSV_DIM 4
+
+// Control CSRs. Each mvin/mvout configuration (CFG 0 to 2) reads its main
+// memory row stride, in bytes, from GMSV_CSR_STRIDE(CFG).
+#define GMSV_CSR_CTRL        0x800
+#define GMSV_CSR_STRIDE(CFG) (0x801 + (CFG))
+
+#define CSR_WRITE(CSR, VALUE) \
+    asm volatile ("csrw %0, %1" :: "i"(CSR), "r"(VALUE))
+
+#define MVIN(RS1, RS2, CFG) \
+    asm volatile ( \
+        ".insn r CUSTOM_0, 0, %c0, x0, %1, %2" :: \
+        "i"(((CFG) & 0x3) << 5), "r"(RS1), "r"(RS2))
+
+#define MVOUT(RS1, RS2, CFG) \
+    asm volatile ( \
+        ".insn r CUSTOM_0, 0, %c0, x0, %1, %2" :: \
+        "i"((((CFG) & 0x3) << 5) | 1), "r"(RS1), "r"(RS2))
+
+#define FENCE(CFG) \
+    asm volatile ( \
+        ".insn r CUSTOM_0, 0, %c0, x0, x0, x0" :: \
+        "i"((((CFG) & 0x3) << 5) | 1) : "memory")
+
+#define MATMUL_PRELOAD(RS1, RS2, CFG) \
+    asm volatile ( \
+        ".insn r CUSTOM_0, 1, %c0, x0, %1, %2" :: \
+        "i"(((CFG) & 0x3) << 5), "r"(RS1), "r"(RS2))
+
+#define MATMUL_COMPUTE(RS1, RS2, END, CFG) \
+    asm volatile ( \
+        ".insn r CUSTOM_0, 1, %c0, x0, %1, %2" :: \
+        "i"(((((CFG) & 0x3) << 5) | (((END) & 0x1) << 2) | 1)), \
+        "r"(RS1), "r"(RS2))
+
+#define MATMUL(MAT_A, MAT_B, MAT_C, MAT_R, CFG) \
+    do { \
+        MATMUL_PRELOAD(MAT_C, MAT_R, CFG); \
+        MATMUL_COMPUTE(MAT_A, MAT_B, 1, CFG); \
+    } while (0)
+
+#endif // __GMSV_H__
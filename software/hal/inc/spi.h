@@ -44,18 +44,39 @@ typedef struct
 #define SPI_CR_PE_Pos                      0x0U
 #define SPI_CR_PE_Mask                     0x1U
 
+#define SPI_SR_RXL_Pos                     0x8U
+#define SPI_SR_RXL_Mask                    0xFFU
+
+#define SPI_SR_ROV_Pos                     0x3U
+#define SPI_SR_ROV_Mask                    0x1U
+
+#define SPI_SR_RWM_Pos                     0x2U
+#define SPI_SR_RWM_Mask                    0x1U
+
 #define SPI_SR_RBF_Pos                     0x1U
 #define SPI_SR_RBF_Mask                    0x1U
 
 #define SPI_SR_TBE_Pos                     0x0U
 #define SPI_SR_TBE_Mask                    0x1U
 
+#define SPI_IER_ROVIE_Pos                  0x3U
+#define SPI_IER_ROVIE_Mask                 0x1U
+
+#define SPI_IER_RWMIE_Pos                  0x2U
+#define SPI_IER_RWMIE_Mask                 0x1U
+
 #define SPI_IER_RBFIE_Pos                  0x1U
 #define SPI_IER_RBFIE_Mask                 0x1U
 
 #define SPI_IER_TBEIE_Pos                  0x0U
 #define SPI_IER_TBEIE_Mask                 0x1U
 
+#define SPI_FCR_TTE_Pos                    0x8U
+#define SPI_FCR_TTE_Mask                   0x1U
+
+#define SPI_FCR_RXWM_Pos                   0x0U
+#define SPI_FCR_RXWM_Mask                  0xFFU
+
 
 #define IS_SPI_DATA_LENGTH(__DATALENGTH__)  (((((uint32_t)__DATALENGTH__) & SPI_CR_DATA_LENGTH_Mask) != 0x00U) &&\
                                              ((((uint32_t)__DATALENGTH__) & ~SPI_CR_DATA_LENGTH_Mask) == 0x00U))
@@ -148,4 +169,62 @@ typedef struct
 uint32_t SPI_ReceiveData();
 void SPI_Init(ral_spi_t *SPI_Init);
 
+/*
+    Asynchronous transfers
+*/
+
+#define SPI_RX_FIFO_DEPTH   16
+
+// Sent when a transfer has no TX buffer
+#define SPI_FILL            0xFF
+
+// No chip select, the transfer leaves the GPIO pins alone
+#define SPI_CS_NONE         (-1)
+
+#define SPI_XFER_QUEUED     0
+#define SPI_XFER_ACTIVE     1
+#define SPI_XFER_DONE       2
+
+struct spi_xfer;
+
+// Called from the SPI interrupt once the transfer is done, the next one is
+// already started. It may submit new transfers.
+typedef void (*spi_xfer_cb_t)(struct spi_xfer *xfer, void *arg);
+
+// Transfer descriptor, owned by the driver from spi_submit() until its
+// status is SPI_XFER_DONE. One buffer byte per SPI word, so the data length
+// of the SPI must not exceed 8 bits.
+typedef struct spi_xfer {
+    const uint8_t *tx;          // NULL sends SPI_FILL
+    uint8_t *rx;                // NULL drops the received words
+    uint32_t len;
+    int cs;                     // GPIO pin held low, or SPI_CS_NONE
+    spi_xfer_cb_t callback;     // May be NULL
+    void *arg;
+    volatile int status;
+
+    // Driver private
+    uint32_t tx_count;
+    uint32_t rx_count;
+    struct spi_xfer *next;
+} spi_xfer_t;
+
+// Driver state of one SPI, the queue of submitted transfers
+typedef struct {
+    ral_spi_t *spi;
+    ral_gpio_t *cs_port;
+    spi_xfer_t *volatile head;
+    spi_xfer_t *tail;
+} spi_async_t;
+
+void spi_async_init(spi_async_t *async, ral_spi_t *spi, ral_gpio_t *cs_port);
+void spi_xfer_init(spi_xfer_t *xfer, const uint8_t *tx, uint8_t *rx,
+                   uint32_t len, int cs, spi_xfer_cb_t callback, void *arg);
+int spi_submit(spi_async_t *async, spi_xfer_t *xfer);
+void spi_async_irq(spi_async_t *async);
+bool spi_xfer_is_done(spi_xfer_t *xfer);
+void spi_xfer_wait(spi_xfer_t *xfer);
+int spi_transfer(spi_async_t *async, const uint8_t *tx, uint8_t *rx,
+                 uint32_t len, int cs);
+
 #endif
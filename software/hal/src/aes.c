@@ -1,5 +1,8 @@
 #include "aes.h"
 
+// Direction of the last aes_config()
+static uint8_t aes_encrypting = 1;
+
 void aes_init(void) {
     // Enable peripheral (bit 1 of CTRL register)
     RAL.AES->CTRL = (1 << AES_CTRL_ENABLE_BIT);
@@ -9,6 +12,9 @@ void aes_init(void) {
     
     // Disable interrupts by default (software can enable if needed)
     RAL.AES->IER = 0;
+    RAL.AES->FIER = 0;
+
+    aes_fifo_flush();
 }
 
 /**
@@ -31,6 +37,7 @@ void aes_config(uint8_t encrypt, uint8_t keylen) {
     // Pour AES_KEYLEN_128, le bit reste à 0
     
     RAL.AES->CONFIG = config;
+    aes_encrypting = encrypt ? 1 : 0;
 }
 
 /**
@@ -107,6 +114,14 @@ uint32_t aes_read_events(void) {
     return RAL.AES->ER;
 }
 
+/**
+ * @brief Empty the block FIFOs, the blocks in the core are discarded
+ */
+void aes_fifo_flush(void) {
+    RAL.AES->FCR = (1 << AES_FCR_FLUSH_BIT);
+    RAL.AES->FSR = (1 << AES_FSR_IOV_BIT) | (1 << AES_FSR_OUD_BIT);
+}
+
 /**
  * @brief Read result (blocking - waits for completion)
  * @param result: 4-word array to store the result
@@ -118,3 +133,281 @@ void aes_read_result(uint32_t *result) {
         __asm__ __volatile__ ("fence rw, rw" : : : "memory");
     }
 }
+
+/*
+    Streams
+
+    Blocks that do not depend on the previous result (ECB and CTR) are
+    written to DIN and read from DOUT. The input FIFO is kept topped up and
+    the output one drained, the core ciphers them back to back in the
+    meantime. CBC encryption chains every block on the previous result, so
+    it is a sequence of single-block operations on BLOCK and RESULT, with
+    START for each one. The core only enciphers: ECB and CBC decryption are
+    rejected until it has a decipher pipeline.
+
+    Either way the key is not rewritten, the block writes and result reads
+    are unrolled and unfenced (the AXI-Lite slave has a single outstanding
+    access, in order), and the CTR counter update overlaps the cipher. The
+    interrupt variant leaves the CPU free in between, it runs on the output
+    watermark of the FIFOs or on the done event.
+*/
+
+#define AES_DONE    (1u << AES_ER_DONE_BIT)
+#define AES_GO      ((1u << AES_CTRL_START_BIT) | (1u << AES_CTRL_ENABLE_BIT))
+#define AES_OWM     (1u << AES_FSR_OWM_BIT)
+
+typedef struct {
+    uint8_t mode;
+    uint8_t fifo;               // Through the block FIFOs
+    uint8_t irq;                // Driven by aes_stream_irq()
+    uint32_t *iv;
+    const uint32_t *in;
+    uint32_t *out;
+    uint32_t nblocks;
+    uint32_t fed;               // Blocks given to the peripheral
+    uint32_t block;             // Blocks read back
+    aes_stream_cb_t callback;
+    void *arg;
+    volatile bool busy;
+} aes_stream_t;
+
+static aes_stream_t aes_stream;
+
+static void aes_put(const aes_stream_t *s, uint32_t w0, uint32_t w1,
+                    uint32_t w2, uint32_t w3) {
+    if (s->fifo) {
+        RAL.AES->DIN = w0;
+        RAL.AES->DIN = w1;
+        RAL.AES->DIN = w2;
+        RAL.AES->DIN = w3;
+        return;
+    }
+
+    RAL.AES->BLOCK = w0;
+    RAL.AES->BLOCK = w1;
+    RAL.AES->BLOCK = w2;
+    RAL.AES->BLOCK = w3;
+
+    // START also rewinds the BLOCK and RESULT word counters
+    RAL.AES->ER = AES_DONE;
+    RAL.AES->CTRL = AES_GO;
+}
+
+// Gives the next block to the peripheral
+static void aes_stream_feed(aes_stream_t *s) {
+    const uint32_t *in = s->in + 4 * s->fed++;
+    uint32_t *iv = s->iv;
+
+    switch (s->mode) {
+    case AES_MODE_CBC:
+        aes_put(s, in[0] ^ iv[0], in[1] ^ iv[1], in[2] ^ iv[2],
+                in[3] ^ iv[3]);
+        break;
+
+    case AES_MODE_CTR:
+        aes_put(s, iv[0], iv[1], iv[2], iv[3]);
+
+        // 128-bit big-endian increment, while the core runs
+        for (int i = 3; i >= 0 && ++iv[i] == 0; i--);
+        break;
+
+    default:
+        aes_put(s, in[0], in[1], in[2], in[3]);
+        break;
+    }
+}
+
+// Reads the result of the oldest block given and moves to the next, the
+// results come in order.
+static void aes_stream_collect(aes_stream_t *s) {
+    const uint32_t *in = s->in + 4 * s->block;
+    uint32_t *out = s->out + 4 * s->block;
+    uint32_t *iv = s->iv;
+    const ral_data_t *src = s->fifo ? &RAL.AES->DOUT : &RAL.AES->RESULT;
+    uint32_t r[4];
+
+    r[0] = *src;
+    r[1] = *src;
+    r[2] = *src;
+    r[3] = *src;
+
+    switch (s->mode) {
+    case AES_MODE_CBC:
+        for (int i = 0; i < 4; i++) {
+            out[i] = r[i];
+            iv[i] = r[i];
+        }
+        break;
+
+    case AES_MODE_CTR:
+        for (int i = 0; i < 4; i++)
+            out[i] = in[i] ^ r[i];
+        break;
+
+    default:
+        for (int i = 0; i < 4; i++)
+            out[i] = r[i];
+        break;
+    }
+
+    s->block++;
+}
+
+// Drains the output FIFO, then tops the input one up. The levels are read
+// once, the core only lowers the input one and raises the output one.
+static void aes_stream_pump(aes_stream_t *s) {
+    uint32_t fsr = RAL.AES->FSR;
+    uint32_t in_level = (fsr >> AES_FSR_IL_SHIFT) & 0xFF;
+    uint32_t out_level = (fsr >> AES_FSR_OL_SHIFT) & 0xFF;
+
+    for (; out_level; out_level--)
+        aes_stream_collect(s);
+
+    for (; in_level < AES_FIFO_DEPTH && s->fed < s->nblocks; in_level++)
+        aes_stream_feed(s);
+}
+
+static int aes_stream_setup(uint8_t mode, uint32_t *iv, const uint32_t *in,
+                            uint32_t *out, uint32_t nblocks) {
+    aes_stream_t *s = &aes_stream;
+
+    if (mode > AES_MODE_CTR)
+        return -1;
+    if (mode != AES_MODE_ECB && !iv)
+        return -1;
+    // The pipelined core only enciphers (encdec is ignored), so ECB and CBC
+    // cannot decrypt. CTR deciphers with the forward cipher.
+    if (mode != AES_MODE_CTR && !aes_encrypting)
+        return -1;
+
+    // Claimed before the state is written and until the last block is read
+    // back, by either entry point
+    if (s->busy)
+        return -1;
+    s->busy = true;
+
+    s->mode = mode;
+    s->fifo = mode != AES_MODE_CBC;
+    s->iv = iv;
+    s->in = in;
+    s->out = out;
+    s->nblocks = nblocks;
+    s->fed = 0;
+    s->block = 0;
+    s->callback = 0;
+    s->arg = 0;
+    s->irq = 0;
+    return 0;
+}
+
+/**
+ * @brief Cipher nblocks blocks, polling the peripheral
+ * @param mode: AES_MODE_ECB, AES_MODE_CBC or AES_MODE_CTR
+ * @param iv: 4 words, updated, unused in ECB
+ * @retval 0, or -1 for a bad mode, ECB/CBC decryption or a stream already
+ *         running
+ * @note  The AES interrupt must be disabled, see aes_crypt_stream_irq()
+ */
+int aes_crypt_stream(uint8_t mode, uint32_t *iv, const uint32_t *in,
+                     uint32_t *out, uint32_t nblocks) {
+    aes_stream_t *s = &aes_stream;
+
+    if (aes_stream_setup(mode, iv, in, out, nblocks))
+        return -1;
+
+    if (s->fifo) {
+        while (s->block < s->nblocks)
+            aes_stream_pump(s);
+    } else {
+        while (s->block < s->nblocks) {
+            aes_stream_feed(s);
+            while (!(RAL.AES->ER & AES_DONE));
+            aes_stream_collect(s);
+        }
+    }
+
+    s->busy = false;
+    return 0;
+}
+
+/**
+ * @brief Start a stream driven by the AES interrupt
+ * @param callback: called from the interrupt at the end, may be NULL
+ * @retval 0, or -1 for a bad mode, ECB/CBC decryption or a stream already
+ *         running
+ * @note  The application routes the AES interrupt to the CPU in the syscfg
+ *        and calls aes_stream_irq() from its handler.
+ */
+int aes_crypt_stream_irq(uint8_t mode, uint32_t *iv, const uint32_t *in,
+                         uint32_t *out, uint32_t nblocks,
+                         aes_stream_cb_t callback, void *arg) {
+    aes_stream_t *s = &aes_stream;
+
+    if (aes_stream_setup(mode, iv, in, out, nblocks))
+        return -1;
+
+    s->callback = callback;
+    s->arg = arg;
+
+    if (!nblocks) {
+        s->busy = false;
+        if (callback)
+            callback(arg);
+        return 0;
+    }
+
+    s->irq = 1;
+
+    if (s->fifo) {
+        // Interrupt as soon as a result is in the output FIFO
+        RAL.AES->FCR = (1 << AES_FCR_OWML_SHIFT);
+        aes_stream_pump(s);
+        RAL.AES->FIER = (1 << AES_FIER_OWMIE_BIT);
+        return 0;
+    }
+
+    RAL.AES->IER = (1 << AES_IER_DONEIE_BIT);
+    aes_stream_feed(s);
+    return 0;
+}
+
+void aes_stream_irq(void) {
+    aes_stream_t *s = &aes_stream;
+
+    if (!s->busy || !s->irq)
+        return;
+
+    if (s->fifo) {
+        if (!(RAL.AES->FSR & AES_OWM))
+            return;
+
+        aes_stream_pump(s);
+
+        if (s->block < s->nblocks)
+            return;
+
+        RAL.AES->FIER = 0;
+    } else {
+        if (!(RAL.AES->ER & AES_DONE))
+            return;
+
+        aes_stream_collect(s);
+
+        if (s->block < s->nblocks) {
+            aes_stream_feed(s);
+            return;
+        }
+
+        RAL.AES->IER = 0;
+        RAL.AES->ER = AES_DONE;
+    }
+
+    s->busy = false;
+
+    if (s->callback)
+        s->callback(s->arg);
+}
+
+bool aes_stream_busy(void) {
+    return aes_stream.busy;
+}
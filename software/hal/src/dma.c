@@ -0,0 +1,68 @@
+#include "dma.h"
+
+void dma_desc_init(dma_desc_t *desc, const volatile void *src,
+                   volatile void *dst, uint32_t count, uint32_t ctrl,
+                   dma_desc_t *next) {
+    desc->src = (uint32_t) src;
+    desc->dst = (uint32_t) dst;
+    desc->count = count;
+    desc->ctrl = ctrl & ~(DMA_CTRL_DONE | DMA_CTRL_ERR);
+    desc->next = next;
+}
+
+/**
+ * @brief Start a descriptor chain
+ * @param dma: DMA index
+ * @param desc: first descriptor
+ * @param req_mask: syscfg interrupts pacing the PACED descriptors
+ */
+void dma_start(int dma, dma_desc_t *desc, uint32_t req_mask) {
+    RAL.SYSCFG->DMA[dma].BAR = (uint32_t) desc;
+    RAL.SYSCFG->DMA[dma].IER = req_mask;
+
+    // RESET restarts from BAR even if a previous chain has ended
+    RAL.SYSCFG->DMA[dma].MR = DMA_MR_RESET;
+    while (RAL.SYSCFG->DMA[dma].MR);
+}
+
+void dma_stop(int dma) {
+    RAL.SYSCFG->DMA[dma].MR = DMA_MR_STOP;
+    while (RAL.SYSCFG->DMA[dma].MR);
+}
+
+bool dma_is_done(dma_desc_t *desc) {
+    return (desc->ctrl & DMA_CTRL_DONE) != 0;
+}
+
+bool dma_has_error(dma_desc_t *desc) {
+    return (desc->ctrl & DMA_CTRL_ERR) != 0;
+}
+
+/**
+ * @brief Wait for a descriptor of the running chain
+ * @param dma: DMA index
+ * @param desc: descriptor to wait for
+ * @return 0 once it is done, -1 on a bus error or if the chain ended without
+ *         reaching it (e.g. an unreadable descriptor before it)
+ */
+int dma_wait(int dma, dma_desc_t *desc) {
+    while (!dma_is_done(desc)) {
+        // The write-back comes before the end of the chain, check it again
+        if (RAL.SYSCFG->DMA[dma].D) {
+            if (!dma_is_done(desc)) return -1;
+            break;
+        }
+    }
+    return dma_has_error(desc) ? -1 : 0;
+}
+
+int dma_memcpy(int dma, void *dst, const void *src, uint32_t words) {
+    dma_desc_t desc;
+    int ret;
+
+    dma_desc_init(&desc, src, dst, words, DMA_CTRL_SINC | DMA_CTRL_DINC, 0);
+    dma_start(dma, &desc, 0);
+    ret = dma_wait(dma, &desc);
+    dma_stop(dma);
+    return ret;
+}
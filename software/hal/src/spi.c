@@ -1,4 +1,5 @@
 
+#include "gpio.h"
 #include "spi.h"
 
 /*
@@ -52,3 +53,182 @@ uint32_t SPI_ReceiveData()
 }
 
 
+
+/*
+    Asynchronous transfers
+
+    The transfers of the queue run one after the other, each one under its
+    chip select. The SPI interrupt drives them: RBF drains the RX FIFO and
+    TBE refills the one word TX buffer. Words are only sent while the RX FIFO
+    has room for their answers, and TBEIE is dropped when there is nothing
+    to send, the interrupt being level-sensitive. Masking the IER of the SPI
+    is all it takes to keep the interrupt out of the queue, the driver owns
+    that register.
+*/
+
+#define SPI_ASYNC_IER   ((1u << SPI_IER_TBEIE_Pos) | (1u << SPI_IER_RBFIE_Pos))
+
+#define barrier()       __asm__ volatile("" ::: "memory")
+
+static void spi_cs(spi_async_t *async, int cs, uint8_t level) {
+    if (cs != SPI_CS_NONE)
+        gpio_write(async->cs_port, cs, level);
+}
+
+// Starts the head of the queue, or masks the interrupt when it is empty
+static void spi_start(spi_async_t *async) {
+    spi_xfer_t *xfer = async->head;
+
+    if (!xfer) {
+        async->spi->IER = 0;
+        return;
+    }
+
+    xfer->tx_count = 0;
+    xfer->rx_count = 0;
+    xfer->status = SPI_XFER_ACTIVE;
+    spi_cs(async, xfer->cs, 0);
+
+    async->spi->IER = SPI_ASYNC_IER;
+}
+
+/**
+ * @brief Set up the driver of a configured and enabled SPI
+ * @param async: driver state
+ * @param spi: SPI, with a data length of at most 8 bits
+ * @param cs_port: GPIO of the chip select pins, their mode is left to the
+ *        caller. May be NULL when no transfer uses one.
+ * @note  The application routes the SPI interrupt to the CPU in the syscfg
+ *        and calls spi_async_irq() from its handler.
+ */
+void spi_async_init(spi_async_t *async, ral_spi_t *spi, ral_gpio_t *cs_port) {
+    spi->IER = 0;
+
+    async->spi = spi;
+    async->cs_port = cs_port;
+    async->head = NULL;
+    async->tail = NULL;
+
+    // Leftovers of a polled use would be taken as answers
+    while (spi->RBF)
+        (void) spi->DR;
+}
+
+void spi_xfer_init(spi_xfer_t *xfer, const uint8_t *tx, uint8_t *rx,
+                   uint32_t len, int cs, spi_xfer_cb_t callback, void *arg) {
+    xfer->tx = tx;
+    xfer->rx = rx;
+    xfer->len = len;
+    xfer->cs = cs;
+    xfer->callback = callback;
+    xfer->arg = arg;
+    xfer->status = SPI_XFER_DONE;
+    xfer->next = NULL;
+}
+
+/**
+ * @brief Queue a transfer, it starts at once when the SPI is idle
+ * @retval 0, or -1 for an empty transfer
+ */
+int spi_submit(spi_async_t *async, spi_xfer_t *xfer) {
+    if (xfer->len == 0)
+        return -1;
+
+    xfer->next = NULL;
+    xfer->status = SPI_XFER_QUEUED;
+
+    uint32_t ier = async->spi->IER;
+    async->spi->IER = 0;
+    barrier();
+
+    if (async->tail)
+        async->tail->next = xfer;
+    else
+        async->head = xfer;
+    async->tail = xfer;
+
+    barrier();
+    if (async->head == xfer)
+        spi_start(async);
+    else
+        async->spi->IER = ier;
+
+    return 0;
+}
+
+/**
+ * @brief Advance the active transfer, to be called from the interrupt
+ *        handler when the SPI interrupt is pending
+ */
+void spi_async_irq(spi_async_t *async) {
+    ral_spi_t *spi = async->spi;
+    spi_xfer_t *xfer = async->head;
+
+    if (!xfer) {
+        spi->IER = 0;
+        return;
+    }
+
+    while (spi->RBF) {
+        uint8_t word = spi->DR;
+        if (xfer->rx)
+            xfer->rx[xfer->rx_count] = word;
+        xfer->rx_count++;
+    }
+
+    while (xfer->tx_count < xfer->len &&
+           xfer->tx_count - xfer->rx_count < SPI_RX_FIFO_DEPTH &&
+           spi->TBE) {
+        spi->DR = xfer->tx ? xfer->tx[xfer->tx_count] : SPI_FILL;
+        xfer->tx_count++;
+    }
+
+    if (xfer->rx_count < xfer->len) {
+        if (xfer->tx_count < xfer->len &&
+            xfer->tx_count - xfer->rx_count < SPI_RX_FIFO_DEPTH)
+            spi->IER = SPI_ASYNC_IER;
+        else
+            spi->IER = 1u << SPI_IER_RBFIE_Pos;
+        return;
+    }
+
+    // The last answer is in, the last word has been clocked out
+    spi_cs(async, xfer->cs, 1);
+
+    spi_xfer_cb_t callback = xfer->callback;
+    void *arg = xfer->arg;
+
+    async->head = xfer->next;
+    if (!async->head)
+        async->tail = NULL;
+    xfer->status = SPI_XFER_DONE;
+
+    spi_start(async);
+
+    if (callback)
+        callback(xfer, arg);
+}
+
+bool spi_xfer_is_done(spi_xfer_t *xfer) {
+    return xfer->status == SPI_XFER_DONE;
+}
+
+void spi_xfer_wait(spi_xfer_t *xfer) {
+    while (!spi_xfer_is_done(xfer));
+}
+
+/**
+ * @brief Blocking transfer through the queue, after the ones already in it
+ * @retval 0, or -1 for an empty transfer
+ */
+int spi_transfer(spi_async_t *async, const uint8_t *tx, uint8_t *rx,
+                 uint32_t len, int cs) {
+    spi_xfer_t xfer;
+
+    spi_xfer_init(&xfer, tx, rx, len, cs, NULL, NULL);
+    if (spi_submit(async, &xfer))
+        return -1;
+
+    spi_xfer_wait(&xfer);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "tensorflow/lite/micro/micro_interpreter.h"
+
+#include "audio_preprocessor_int8_tflite.h"
+#include "cfg.h"
+#include "frontend.h"
+#include "kws_ops.h"
+
+// Checks that the native frontend (CFG_NATIVE_FRONTEND) computes the same
+// int8 features as the audio preprocessor model. Synthetic signals are fed
+// frame by frame, with the feature stride, to both of them and every feature
+// frame is compared. Reports, as CSV lines:
+//   frontend,<signal>,<frames>,<mismatched frames>,<model_us>,<native_us>
+//   mismatch,<signal>,<frame>,<channel>,<model>,<native>
+// and exits with 1 on any mismatch.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kArenaSize = 64 * 1024;
+alignas(16) uint8_t g_arena[kArenaSize];
+
+// Mismatches printed per signal, the count covers all of them
+constexpr int kMaxReported = 8;
+
+// Numerical Recipes LCG, the signals are the same on every run
+struct Lcg {
+  uint32_t state;
+  int32_t Next(int32_t amplitude) {
+    state = state * 1664525u + 1013904223u;
+    return static_cast<int32_t>((static_cast<int64_t>(state >> 16) - 32768) *
+                                amplitude / 32768);
+  }
+};
+
+int16_t Clamp(double x) {
+  return static_cast<int16_t>(std::max(-32768.0, std::min(32767.0,
+                                                          std::round(x))));
+}
+
+struct Signal {
+  const char* name;
+  std::function<int16_t(int)> sample;
+};
+
+// Two seconds each, long enough for the noise estimate to settle
+constexpr int kLength = 2 * CFG_SAMPLE_RATE;
+
+std::vector<Signal> Signals(void) {
+  constexpr double kPi = 3.14159265358979323846;
+  const double rate = CFG_SAMPLE_RATE;
+
+  return {
+    {"silence", [](int) { return int16_t{0}; }},
+    {"noise_low", [lcg = Lcg{1}](int) mutable {
+       return static_cast<int16_t>(lcg.Next(16));
+     }},
+    {"noise_full", [lcg = Lcg{2}](int) mutable {
+       return static_cast<int16_t>(lcg.Next(32767));
+     }},
+    {"tone_1k", [=](int i) {
+       return Clamp(8000 * std::sin(2 * kPi * 1000 * i / rate));
+     }},
+    {"tone_quiet", [=](int i) {
+       return Clamp(3 * std::sin(2 * kPi * 440 * i / rate));
+     }},
+    // Full scale, the window reaches -32768
+    {"square_clipped", [](int i) {
+       return static_cast<int16_t>((i / 20) & 1 ? 32767 : -32768);
+     }},
+    // 100 Hz up to 100 Hz below Nyquist
+    {"chirp", [=](int i) {
+       const double t = i / rate;
+       const double sweep = (rate / 2 - 200) / (kLength / rate);
+       return Clamp(20000 * std::sin(2 * kPi * (100 + sweep * t / 2) * t));
+     }},
+    {"impulses", [](int i) {
+       return static_cast<int16_t>(i % 797 == 0 ? 30000 : 0);
+     }},
+    // Silence, a voiced burst and silence again, as a keyword would be
+    {"burst", [=, lcg = Lcg{3}](int i) mutable {
+       const int32_t noise = lcg.Next(32);
+       if (i < kLength / 4 || i >= 3 * kLength / 4) return Clamp(noise);
+       double x = 0;
+       for (int k = 1; k <= 3; k++) {
+         x += std::sin(2 * kPi * 300 * k * i / rate) / k;
+       }
+       return Clamp(6000 * x + noise);
+     }},
+  };
+}
+
+double Elapsed(Clock::time_point t0, Clock::time_point t1) {
+  return std::chrono::duration<double, std::micro>(t1 - t0).count();
+}
+
+}  // namespace
+
+int main(void) {
+  PreprocessorOpResolver resolver;
+  if (RegisterPreprocessorOps(resolver) != kTfLiteOk) {
+    fprintf(stderr, "cannot register the preprocessor operators\n");
+    return 1;
+  }
+
+  tflite::MicroInterpreter interpreter(
+      tflite::GetModel(__audio_preprocessor_int8_tflite), resolver, g_arena,
+      kArenaSize);
+  if (interpreter.AllocateTensors() != kTfLiteOk) {
+    fprintf(stderr, "cannot allocate the preprocessor tensors\n");
+    return 1;
+  }
+  if (frontend_init() != 0) {
+    fprintf(stderr, "cannot initialize the frontend\n");
+    return 1;
+  }
+
+  int16_t* model_in = tflite::GetTensorData<int16_t>(interpreter.input(0));
+  const int8_t* model_out =
+      tflite::GetTensorData<int8_t>(interpreter.output(0));
+
+  int failures = 0;
+
+  for (Signal& signal : Signals()) {
+    std::vector<int16_t> samples(kLength);
+    for (int i = 0; i < kLength; i++) samples[i] = signal.sample(i);
+
+    // Both start from a zero noise estimate
+    interpreter.Reset();
+    frontend_reset();
+
+    int frames = 0;
+    int mismatched = 0;
+    int reported = 0;
+    double model_us = 0;
+    double native_us = 0;
+
+    for (size_t offset = 0;
+         offset + CFG_AUDIO_DURATION_COUNT <= samples.size();
+         offset += CFG_AUDIO_STRIDE_COUNT) {
+      const int16_t* frame = samples.data() + offset;
+      int8_t native[CFG_FEATURE_SIZE];
+
+      const Clock::time_point t0 = Clock::now();
+      std::copy_n(frame, CFG_AUDIO_DURATION_COUNT, model_in);
+      if (interpreter.Invoke() != kTfLiteOk) {
+        fprintf(stderr, "%s: preprocessor invoke failed\n", signal.name);
+        return 1;
+      }
+      const Clock::time_point t1 = Clock::now();
+      frontend_run(frame, native);
+      const Clock::time_point t2 = Clock::now();
+
+      model_us += Elapsed(t0, t1);
+      native_us += Elapsed(t1, t2);
+
+      if (memcmp(model_out, native, CFG_FEATURE_SIZE) != 0) {
+        mismatched++;
+        for (int c = 0; c < CFG_FEATURE_SIZE && reported < kMaxReported;
+             c++) {
+          if (model_out[c] == native[c]) continue;
+          printf("mismatch,%s,%d,%d,%d,%d\n", signal.name, frames, c,
+                 model_out[c], native[c]);
+          reported++;
+        }
+      }
+      frames++;
+    }
+
+    printf("frontend,%s,%d,%d,%.2f,%.2f\n", signal.name, frames, mismatched,
+           model_us / frames, native_us / frames);
+    failures += mismatched;
+  }
+
+  if (failures) {
+    fprintf(stderr, "frontend_check: %d mismatched frame(s)\n", failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+extern "C" {
+#include "ingest.h"
+}
+
+// Checks the block ingest kernel (ingest_block) against a scalar high-pass
+// filter and a 64-bit energy sum. Random and saturating signals are fed in
+// blocks of random sizes, across the energy chunks and in place or not, and
+// every filtered sample and block energy is compared. Reports, as CSV lines:
+//   ingest,<signal>,<blocks>,<mismatched blocks>
+//   mismatch,<signal>,<block>,<what>,<reference>,<kernel>
+// and exits with 1 on any mismatch.
+
+namespace {
+
+// Mismatches printed per signal, the count covers all of them
+constexpr int kMaxReported = 8;
+
+// Longer than the 63-sample energy chunks of the kernel
+constexpr int kMaxBlock = 300;
+
+constexpr int kLength = 4 * CFG_SAMPLE_RATE;
+
+// Numerical Recipes LCG, the signals are the same on every run
+struct Lcg {
+  uint32_t state;
+  uint32_t Next(void) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  }
+  int32_t Uniform(int32_t lo, int32_t hi) {
+    return lo + static_cast<int32_t>(Next() %
+                                     static_cast<uint32_t>(hi - lo + 1));
+  }
+};
+
+struct Signal {
+  const char* name;
+  std::function<int16_t(int)> sample;
+};
+
+std::vector<Signal> Signals(void) {
+  return {
+    {"noise_low", [lcg = Lcg{1}](int) mutable {
+       return static_cast<int16_t>(lcg.Uniform(-64, 64));
+     }},
+    {"noise_full", [lcg = Lcg{2}](int) mutable {
+       return static_cast<int16_t>(lcg.Uniform(-32768, 32767));
+     }},
+    // Full-scale steps every sample, the filter output clips
+    {"alternate", [](int i) {
+       return static_cast<int16_t>(i & 1 ? 32767 : -32768);
+     }},
+    {"square_full", [](int i) {
+       return static_cast<int16_t>((i / 40) & 1 ? 32767 : -32768);
+     }},
+    {"dc_full", [](int) { return int16_t{32767}; }},
+    // Long clipped runs, the block energy saturates
+    {"bursts", [lcg = Lcg{3}](int i) mutable {
+       if ((i / 4000) & 1) return static_cast<int16_t>(lcg.Uniform(-8, 8));
+       return static_cast<int16_t>(i & 1 ? 32767 : -32768);
+     }},
+  };
+}
+
+// Scalar reference, y[n] = x[n] - x[n-1] + R*y[n-1] and sum(y^2 >> 4)
+struct Reference {
+  int32_t prev_in = 0;
+  int32_t prev_out = 0;
+
+  uint32_t Block(const int16_t* in, int16_t* out, int n) {
+    uint64_t energy = 0;
+    for (int i = 0; i < n; i++) {
+      const int32_t y = (in[i] - prev_in) +
+                        ((prev_out * CFG_AUDIO_HPF) >> 15);
+      prev_in = in[i];
+      prev_out = y;
+      const int32_t s = std::clamp<int32_t>(y, -32768, 32767);
+      out[i] = static_cast<int16_t>(s);
+      energy += static_cast<uint64_t>(s * s) >> INGEST_ENERGY_SHIFT;
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(energy, UINT32_MAX));
+  }
+};
+
+}  // namespace
+
+int main(void) {
+  int failures = 0;
+
+  for (Signal& signal : Signals()) {
+    std::vector<int16_t> samples(kLength);
+    for (int i = 0; i < kLength; i++) samples[i] = signal.sample(i);
+
+    Lcg sizes = {4};
+    Reference reference;
+    ingest_hpf_t hpf = {0, 0};
+
+    int blocks = 0;
+    int mismatched = 0;
+    int reported = 0;
+
+    for (int offset = 0; offset < kLength; blocks++) {
+      const int n = std::min<int>(sizes.Uniform(1, kMaxBlock),
+                                  kLength - offset);
+      const int16_t* in = samples.data() + offset;
+      int16_t expected[kMaxBlock];
+      int16_t actual[kMaxBlock];
+
+      // Every other block in place, as the capture path does
+      const uint32_t expected_energy = reference.Block(in, expected, n);
+      uint32_t actual_energy;
+      if (blocks & 1) {
+        std::copy_n(in, n, actual);
+        actual_energy = ingest_block(&hpf, actual, actual, n);
+      } else {
+        actual_energy = ingest_block(&hpf, in, actual, n);
+      }
+
+      bool mismatch = false;
+      for (int i = 0; i < n; i++) {
+        if (expected[i] == actual[i]) continue;
+        mismatch = true;
+        if (reported < kMaxReported) {
+          printf("mismatch,%s,%d,sample %d,%d,%d\n", signal.name, blocks, i,
+                 expected[i], actual[i]);
+          reported++;
+        }
+      }
+      if (expected_energy != actual_energy) {
+        mismatch = true;
+        if (reported < kMaxReported) {
+          printf("mismatch,%s,%d,energy,%u,%u\n", signal.name, blocks,
+                 expected_energy, actual_energy);
+          reported++;
+        }
+      }
+      if (mismatch) mismatched++;
+
+      offset += n;
+    }
+
+    printf("ingest,%s,%d,%d\n", signal.name, blocks, mismatched);
+    failures += mismatched;
+  }
+
+  if (failures) {
+    fprintf(stderr, "ingest_check: %d mismatched block(s)\n", failures);
+    return 1;
+  }
+  return 0;
+}
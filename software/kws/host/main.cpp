@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "inference.h"
+
+// Runs the KWS pipeline on audio files and reports, as CSV lines:
+//   window,<file>,<offset>,<label>,<top>,<preproc_us>,<speech_us>
+//   confusion,<label>,<count per predicted category>...
+//   summary,<key>,<value>
+// Files are 16-bit mono WAV or raw little-endian PCM at CFG_SAMPLE_RATE. The
+// label of a file is given by --list (lines of "<path> <label>") or else by
+// its parent directory, as in the speech_commands dataset. Words that are
+// not a category count as "unknown", "_silence_" as "silence".
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Clip {
+  std::string path;
+  std::string label;
+};
+
+struct Totals {
+  uint64_t windows = 0;
+  uint64_t labelled = 0;
+  uint64_t correct = 0;
+  double preproc_us = 0;
+  double speech_us = 0;
+  double max_us = 0;
+  std::vector<std::vector<uint64_t>> confusion;
+};
+
+bool ReadFile(const std::string& path, std::vector<uint8_t>& bytes) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  bytes.assign(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+  return true;
+}
+
+uint32_t ReadLe(const uint8_t* p, int size) {
+  uint32_t value = 0;
+  for (int i = size - 1; i >= 0; i--) value = value << 8 | p[i];
+  return value;
+}
+
+void ToSamples(const uint8_t* data, size_t size, std::vector<int16_t>& out) {
+  out.resize(size / 2);
+  for (size_t i = 0; i < out.size(); i++) {
+    out[i] = static_cast<int16_t>(ReadLe(data + 2 * i, 2));
+  }
+}
+
+bool LoadAudio(const std::string& path, std::vector<int16_t>& samples) {
+  std::vector<uint8_t> bytes;
+  if (!ReadFile(path, bytes)) {
+    fprintf(stderr, "%s: cannot read\n", path.c_str());
+    return false;
+  }
+
+  const bool wav = bytes.size() >= 12 &&
+                   memcmp(bytes.data(), "RIFF", 4) == 0 &&
+                   memcmp(bytes.data() + 8, "WAVE", 4) == 0;
+  if (!wav) {
+    ToSamples(bytes.data(), bytes.size(), samples);
+    return true;
+  }
+
+  bool format_ok = false;
+  size_t pos = 12;
+  while (pos + 8 <= bytes.size()) {
+    const uint8_t* chunk = bytes.data() + pos;
+    const size_t size = std::min<size_t>(ReadLe(chunk + 4, 4),
+                                         bytes.size() - pos - 8);
+
+    if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+      const uint32_t format = ReadLe(chunk + 8, 2);
+      const uint32_t channels = ReadLe(chunk + 10, 2);
+      const uint32_t rate = ReadLe(chunk + 12, 4);
+      const uint32_t bits = ReadLe(chunk + 22, 2);
+      format_ok = format == 1 && channels == 1 && bits == 16 &&
+                  rate == CFG_SAMPLE_RATE;
+      if (!format_ok) {
+        fprintf(stderr, "%s: need 16-bit mono PCM at %d Hz\n", path.c_str(),
+                CFG_SAMPLE_RATE);
+        return false;
+      }
+    } else if (memcmp(chunk, "data", 4) == 0 && format_ok) {
+      ToSamples(chunk + 8, size, samples);
+      return true;
+    }
+
+    pos += 8 + size + (size & 1);
+  }
+
+  fprintf(stderr, "%s: no PCM data\n", path.c_str());
+  return false;
+}
+
+std::string DirectoryLabel(const std::string& path) {
+  const size_t end = path.find_last_of('/');
+  if (end == std::string::npos || end == 0) return "";
+  const size_t begin = path.find_last_of('/', end - 1);
+  return path.substr(begin == std::string::npos ? 0 : begin + 1,
+                     end - (begin == std::string::npos ? 0 : begin + 1));
+}
+
+// Category index of a label, -1 when the clip is unlabelled
+int LabelCategory(const std::string& label) {
+  if (label.empty()) return -1;
+  if (label == "_silence_") return 0;
+
+  int unknown = -1;
+  for (int i = 0; i < inference_category_count(); i++) {
+    if (label == inference_category_label(i)) return i;
+    if (strcmp(inference_category_label(i), "unknown") == 0) unknown = i;
+  }
+  return unknown;
+}
+
+bool LoadList(const std::string& path, std::vector<Clip>& clips) {
+  std::ifstream file(path);
+  if (!file) {
+    fprintf(stderr, "%s: cannot read\n", path.c_str());
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    Clip clip;
+    if (!(fields >> clip.path) || clip.path[0] == '#') continue;
+    fields >> clip.label;
+    clips.push_back(clip);
+  }
+  return true;
+}
+
+double Elapsed(Clock::time_point t0, Clock::time_point t1) {
+  return std::chrono::duration<double, std::micro>(t1 - t0).count();
+}
+
+void RunClip(const Clip& clip, int repeat, Totals& totals) {
+  std::vector<int16_t> samples;
+  if (!LoadAudio(clip.path, samples)) return;
+
+  // Short clips are zero padded to one window, longer recordings are
+  // scanned with the detection hop
+  if (samples.size() < CFG_AUDIO_DATA_SIZE) {
+    samples.resize(CFG_AUDIO_DATA_SIZE, 0);
+  }
+
+  const int category = LabelCategory(clip.label);
+
+  for (size_t offset = 0; offset + CFG_AUDIO_DATA_SIZE <= samples.size();
+       offset += CFG_AUDIO_WINDOW_HOP) {
+    double preproc_us = 0;
+    double speech_us = 0;
+
+    for (int r = 0; r < repeat; r++) {
+      const Clock::time_point t0 = Clock::now();
+      inference_preproc_run(samples.data() + offset, CFG_AUDIO_DATA_SIZE);
+      const Clock::time_point t1 = Clock::now();
+      inference_speech_run();
+      const Clock::time_point t2 = Clock::now();
+
+      preproc_us += Elapsed(t0, t1);
+      speech_us += Elapsed(t1, t2);
+    }
+    preproc_us /= repeat;
+    speech_us /= repeat;
+
+    const int top = inference_speech_top();
+    printf("window,%s,%zu,%s,%s,%.1f,%.1f\n", clip.path.c_str(), offset,
+           category < 0 ? "none" : inference_category_label(category),
+           inference_category_label(top), preproc_us, speech_us);
+
+    totals.windows++;
+    totals.preproc_us += preproc_us;
+    totals.speech_us += speech_us;
+    totals.max_us = std::max(totals.max_us, preproc_us + speech_us);
+
+    if (category >= 0 && top >= 0) {
+      totals.labelled++;
+      totals.correct += top == category;
+      totals.confusion[category][top]++;
+    }
+  }
+}
+
+void Report(const Totals& totals) {
+  for (int i = 0; i < inference_category_count(); i++) {
+    printf("confusion,%s", inference_category_label(i));
+    for (uint64_t count : totals.confusion[i]) {
+      printf(",%llu", static_cast<unsigned long long>(count));
+    }
+    printf("\n");
+  }
+
+  const double windows = totals.windows ? totals.windows : 1;
+  const double mean_us = (totals.preproc_us + totals.speech_us) / windows;
+  const double window_s = static_cast<double>(CFG_AUDIO_DATA_SIZE) /
+                          CFG_SAMPLE_RATE;
+
+  printf("summary,model,%s\n",
+         inference_speech_model_name(inference_speech_selected()));
+  printf("summary,windows,%llu\n",
+         static_cast<unsigned long long>(totals.windows));
+  printf("summary,preproc_us,%.1f\n", totals.preproc_us / windows);
+  printf("summary,speech_us,%.1f\n", totals.speech_us / windows);
+  printf("summary,latency_us,%.1f\n", mean_us);
+  printf("summary,latency_max_us,%.1f\n", totals.max_us);
+  printf("summary,windows_per_s,%.1f\n", mean_us > 0 ? 1e6 / mean_us : 0);
+  printf("summary,realtime_factor,%.1f\n",
+         mean_us > 0 ? window_s * 1e6 / mean_us : 0);
+  printf("summary,labelled,%llu\n",
+         static_cast<unsigned long long>(totals.labelled));
+  if (totals.labelled) {
+    printf("summary,accuracy,%.4f\n",
+           static_cast<double>(totals.correct) / totals.labelled);
+  }
+}
+
+void Usage(const char* name) {
+  fprintf(stderr,
+          "usage: %s [--list FILE] [--repeat N] [--model NAME] [AUDIO...]\n"
+          "  --list FILE   clips to run, one \"<path> [label]\" per line\n"
+          "  --repeat N    run each window N times and average the latency\n"
+          "  --model NAME  registered speech model to run\n",
+          name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<Clip> clips;
+  int repeat = 1;
+  const char* model = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--list") == 0 && i + 1 < argc) {
+      if (!LoadList(argv[++i], clips)) return 1;
+    } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      repeat = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+      model = argv[++i];
+    } else if (argv[i][0] == '-') {
+      Usage(argv[0]);
+      return 1;
+    } else {
+      clips.push_back({argv[i], DirectoryLabel(argv[i])});
+    }
+  }
+
+  if (clips.empty()) {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  inference_preproc_init();
+  inference_speech_init();
+
+  if (model) {
+    int index = 0;
+    while (index < inference_speech_model_count() &&
+           strcmp(inference_speech_model_name(index), model) != 0) {
+      index++;
+    }
+    if (inference_speech_select(index) != 0) {
+      fprintf(stderr, "unknown model: %s\n", model);
+      return 1;
+    }
+  }
+
+  Totals totals;
+  totals.confusion.assign(inference_category_count(),
+                          std::vector<uint64_t>(inference_category_count()));
+
+  for (const Clip& clip : clips) RunClip(clip, repeat, totals);
+
+  Report(totals);
+  return 0;
+}
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/micro/kernels/depthwise_conv.h"
+#include "tensorflow/lite/micro/kernels/fully_connected.h"
+#include "tensorflow/lite/micro/kernels/kernel_runner.h"
+
+#include "opt_kernels.h"
+
+// Checks that the optimized int8 kernels (CFG_OPT_KERNELS) produce the same
+// outputs as the TFLM reference kernels. Both run on randomized shapes,
+// zero points, scales, activations, strides and padding, including the
+// shapes they hand back to the reference. Reports, as CSV lines:
+//   kernel,<name>,<trials>,<mismatched trials>
+//   mismatch,<name>,<trial>,<index>,<reference>,<optimized>
+// and exits with 1 on any mismatch.
+
+namespace {
+
+constexpr int kTrials = 500;
+
+// Mismatches printed per kernel, the count covers all of them
+constexpr int kMaxReported = 8;
+
+// Numerical Recipes LCG, the trials are the same on every run
+struct Lcg {
+  uint32_t state;
+  uint32_t Next(void) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+  }
+  int Uniform(int lo, int hi) {
+    return lo + static_cast<int>(Next() % static_cast<uint32_t>(hi - lo + 1));
+  }
+  float Uniform(float lo, float hi) {
+    return lo + (hi - lo) * static_cast<float>(Next() & 0xffff) / 65535.0f;
+  }
+};
+
+// Backing store of the TfLite arrays and quantization parameters of one
+// trial, the tensors only point to them
+class Storage {
+ public:
+  TfLiteIntArray* Ints(const std::vector<int>& values) {
+    return reinterpret_cast<TfLiteIntArray*>(Words(values.data(),
+                                                   values.size()));
+  }
+
+  TfLiteFloatArray* Floats(const std::vector<float>& values) {
+    return reinterpret_cast<TfLiteFloatArray*>(Words(values.data(),
+                                                     values.size()));
+  }
+
+  // Affine quantization along dimension, one scale per tensor or per
+  // channel. Only the first zero point may be nonzero.
+  void Quantize(TfLiteTensor& tensor, const std::vector<float>& scales,
+                int zero_point, int dimension) {
+    std::vector<int> zero_points(scales.size(), 0);
+    zero_points[0] = zero_point;
+    quantizations_.push_back({Floats(scales), Ints(zero_points), dimension});
+    tensor.params = {scales[0], zero_point};
+    tensor.quantization = {kTfLiteAffineQuantization, &quantizations_.back()};
+  }
+
+ private:
+  int32_t* Words(const void* values, size_t count) {
+    std::vector<int32_t>& words = arrays_.emplace_back(count + 1);
+    words[0] = static_cast<int32_t>(count);
+    memcpy(&words[1], values, count * sizeof(int32_t));
+    return words.data();
+  }
+
+  std::deque<std::vector<int32_t>> arrays_;
+  std::deque<TfLiteAffineQuantization> quantizations_;
+};
+
+template <typename T>
+TfLiteTensor Tensor(std::vector<T>& data, TfLiteIntArray* dims,
+                    TfLiteType type) {
+  TfLiteTensor tensor = {};
+  tensor.type = type;
+  tensor.data.raw = reinterpret_cast<char*>(data.data());
+  tensor.dims = dims;
+  tensor.bytes = data.size() * sizeof(T);
+  tensor.allocation_type = kTfLiteMemNone;
+  return tensor;
+}
+
+std::vector<int8_t> RandomInt8(Lcg& lcg, size_t count) {
+  std::vector<int8_t> data(count);
+  for (int8_t& x : data) x = static_cast<int8_t>(lcg.Uniform(-128, 127));
+  return data;
+}
+
+TfLiteFusedActivation RandomActivation(Lcg& lcg) {
+  static const TfLiteFusedActivation kActivations[] = {
+    kTfLiteActNone, kTfLiteActRelu, kTfLiteActReluN1To1, kTfLiteActRelu6,
+  };
+  return kActivations[lcg.Uniform(0, 3)];
+}
+
+struct Result {
+  int mismatched = 0;
+  int reported = 0;
+  bool failed = false;
+};
+
+void Compare(const char* name, int trial, const std::vector<int8_t>& ref,
+             const std::vector<int8_t>& opt, Result& result) {
+  bool mismatch = false;
+  for (size_t i = 0; i < ref.size(); i++) {
+    if (ref[i] == opt[i]) continue;
+    mismatch = true;
+    if (result.reported < kMaxReported) {
+      printf("mismatch,%s,%d,%zu,%d,%d\n", name, trial, i, ref[i], opt[i]);
+      result.reported++;
+    }
+  }
+  if (mismatch) result.mismatched++;
+}
+
+// FullyConnected =============================================================
+
+void FullyConnectedTrial(Lcg& lcg, int trial, Result& result) {
+  const int batches = lcg.Uniform(1, 3);
+  // Mostly word multiples, the optimized path, otherwise the fallback
+  const int depth = lcg.Uniform(0, 3) ? 4 * lcg.Uniform(1, 64)
+                                      : lcg.Uniform(1, 64);
+  const int rows = lcg.Uniform(1, 48);
+  const bool has_bias = lcg.Uniform(0, 3) != 0;
+
+  const float input_scale = lcg.Uniform(0.01f, 0.5f);
+  const float filter_scale = lcg.Uniform(0.001f, 0.05f);
+  const float output_scale = lcg.Uniform(0.02f, 1.0f);
+  const int input_zero_point = lcg.Uniform(-128, 127);
+  const int output_zero_point = lcg.Uniform(-128, 127);
+
+  // Heap buffers are word aligned, as the arena hands the weights out
+  std::vector<int8_t> input = RandomInt8(lcg, batches * depth);
+  std::vector<int8_t> filter = RandomInt8(lcg, rows * depth);
+  for (int8_t& f : filter) f = std::max<int8_t>(f, -127);
+  std::vector<int32_t> bias(rows);
+  for (int32_t& b : bias) b = lcg.Uniform(-20000, 20000);
+
+  TfLiteFullyConnectedParams params = {};
+  params.activation = RandomActivation(lcg);
+
+  std::vector<int8_t> outputs[2];
+  const TFLMRegistration registrations[2] = {
+    tflite::Register_FULLY_CONNECTED(), Register_FULLY_CONNECTED_OPT(),
+  };
+
+  for (int k = 0; k < 2; k++) {
+    Storage storage;
+    outputs[k].assign(batches * rows, 0);
+
+    std::vector<TfLiteTensor> tensors;
+    tensors.push_back(Tensor(input, storage.Ints({batches, depth}),
+                             kTfLiteInt8));
+    tensors.push_back(Tensor(filter, storage.Ints({rows, depth}),
+                             kTfLiteInt8));
+    if (has_bias) {
+      tensors.push_back(Tensor(bias, storage.Ints({rows}), kTfLiteInt32));
+    }
+    tensors.push_back(Tensor(outputs[k], storage.Ints({batches, rows}),
+                             kTfLiteInt8));
+
+    storage.Quantize(tensors[0], {input_scale}, input_zero_point, 0);
+    storage.Quantize(tensors[1], {filter_scale}, 0, 0);
+    if (has_bias) {
+      storage.Quantize(tensors[2], {input_scale * filter_scale}, 0, 0);
+    }
+    storage.Quantize(tensors.back(), {output_scale}, output_zero_point, 0);
+
+    // Without bias the input list carries -1, as the converter writes it
+    std::vector<int> input_indices = {0, 1, has_bias ? 2 : -1};
+    tflite::micro::KernelRunner runner(
+        registrations[k], tensors.data(), static_cast<int>(tensors.size()),
+        storage.Ints(input_indices),
+        storage.Ints({static_cast<int>(tensors.size()) - 1}), &params);
+    if (runner.InitAndPrepare() != kTfLiteOk ||
+        runner.Invoke() != kTfLiteOk) {
+      fprintf(stderr, "fully_connected,%d: %s kernel failed\n", trial,
+              k ? "optimized" : "reference");
+      result.failed = true;
+      return;
+    }
+  }
+
+  Compare("fully_connected", trial, outputs[0], outputs[1], result);
+}
+
+// DepthwiseConv2D ============================================================
+
+int OutputSize(TfLitePadding padding, int input, int filter, int stride) {
+  if (padding == kTfLitePaddingSame) return (input + stride - 1) / stride;
+  return (input - filter + stride) / stride;
+}
+
+void DepthwiseConvTrial(Lcg& lcg, int trial, Result& result) {
+  // The first trial is the KWS model layer
+  const bool kws = trial == 0;
+  const int batches = kws ? 1 : lcg.Uniform(1, 2);
+  const int input_height = kws ? 49 : lcg.Uniform(1, 16);
+  const int input_width = kws ? 40 : lcg.Uniform(1, 16);
+  const TfLitePadding padding = kws || lcg.Uniform(0, 1)
+                                ? kTfLitePaddingSame : kTfLitePaddingValid;
+  // A valid window fits in the input
+  const int max_height = padding == kTfLitePaddingValid ? input_height : 10;
+  const int max_width = padding == kTfLitePaddingValid ? input_width : 10;
+  const int filter_height = kws ? 10 : lcg.Uniform(1, max_height);
+  const int filter_width = kws ? 8 : lcg.Uniform(1, max_width);
+  const int stride_height = kws ? 2 : lcg.Uniform(1, 3);
+  const int stride_width = kws ? 2 : lcg.Uniform(1, 3);
+  // Multi-channel inputs are handed back to the reference
+  const int input_channels = kws || lcg.Uniform(0, 7) ? 1 : 2;
+  const int multiplier = kws ? 8 : lcg.Uniform(1, 8);
+  const int channels = input_channels * multiplier;
+  const bool has_bias = kws || lcg.Uniform(0, 3) != 0;
+
+  const int output_height = OutputSize(padding, input_height, filter_height,
+                                       stride_height);
+  const int output_width = OutputSize(padding, input_width, filter_width,
+                                      stride_width);
+
+  const float input_scale = lcg.Uniform(0.01f, 0.5f);
+  const float output_scale = lcg.Uniform(0.02f, 1.0f);
+  const int input_zero_point = lcg.Uniform(-128, 127);
+  const int output_zero_point = lcg.Uniform(-128, 127);
+  std::vector<float> filter_scales(channels);
+  for (float& s : filter_scales) s = lcg.Uniform(0.001f, 0.05f);
+  std::vector<float> bias_scales(channels);
+  for (int c = 0; c < channels; c++) {
+    bias_scales[c] = input_scale * filter_scales[c];
+  }
+
+  std::vector<int8_t> input = RandomInt8(
+      lcg, batches * input_height * input_width * input_channels);
+  std::vector<int8_t> filter = RandomInt8(
+      lcg, filter_height * filter_width * channels);
+  for (int8_t& f : filter) f = std::max<int8_t>(f, -127);
+  std::vector<int32_t> bias(channels);
+  for (int32_t& b : bias) b = lcg.Uniform(-20000, 20000);
+
+  TfLiteDepthwiseConvParams params = {};
+  params.padding = padding;
+  params.stride_width = stride_width;
+  params.stride_height = stride_height;
+  params.depth_multiplier = multiplier;
+  params.activation = RandomActivation(lcg);
+  params.dilation_width_factor = 1;
+  params.dilation_height_factor = 1;
+
+  std::vector<int8_t> outputs[2];
+  const TFLMRegistration registrations[2] = {
+    tflite::Register_DEPTHWISE_CONV_2D(), Register_DEPTHWISE_CONV_2D_OPT(),
+  };
+
+  for (int k = 0; k < 2; k++) {
+    Storage storage;
+    outputs[k].assign(batches * output_height * output_width * channels, 0);
+
+    std::vector<TfLiteTensor> tensors;
+    tensors.push_back(Tensor(
+        input,
+        storage.Ints({batches, input_height, input_width, input_channels}),
+        kTfLiteInt8));
+    tensors.push_back(Tensor(
+        filter, storage.Ints({1, filter_height, filter_width, channels}),
+        kTfLiteInt8));
+    tensors.push_back(Tensor(bias, storage.Ints({channels}), kTfLiteInt32));
+    tensors.push_back(Tensor(
+        outputs[k],
+        storage.Ints({batches, output_height, output_width, channels}),
+        kTfLiteInt8));
+
+    storage.Quantize(tensors[0], {input_scale}, input_zero_point, 0);
+    storage.Quantize(tensors[1], filter_scales, 0, 3);
+    storage.Quantize(tensors[2], bias_scales, 0, 0);
+    storage.Quantize(tensors[3], {output_scale}, output_zero_point, 0);
+
+    std::vector<int> input_indices = {0, 1, has_bias ? 2 : -1};
+    tflite::micro::KernelRunner runner(
+        registrations[k], tensors.data(), static_cast<int>(tensors.size()),
+        storage.Ints(input_indices), storage.Ints({3}), &params);
+    if (runner.InitAndPrepare() != kTfLiteOk ||
+        runner.Invoke() != kTfLiteOk) {
+      fprintf(stderr, "depthwise_conv,%d: %s kernel failed\n", trial,
+              k ? "optimized" : "reference");
+      result.failed = true;
+      return;
+    }
+  }
+
+  Compare("depthwise_conv", trial, outputs[0], outputs[1], result);
+}
+
+}  // namespace
+
+int main(void) {
+  struct Kernel {
+    const char* name;
+    void (*trial)(Lcg&, int, Result&);
+    uint32_t seed;
+  };
+  const Kernel kKernels[] = {
+    {"fully_connected", FullyConnectedTrial, 1},
+    {"depthwise_conv", DepthwiseConvTrial, 2},
+  };
+
+  int failures = 0;
+
+  for (const Kernel& kernel : kKernels) {
+    Lcg lcg = {kernel.seed};
+    Result result;
+    for (int trial = 0; trial < kTrials && !result.failed; trial++) {
+      kernel.trial(lcg, trial, result);
+    }
+    printf("kernel,%s,%d,%d\n", kernel.name, kTrials, result.mismatched);
+    failures += result.mismatched + result.failed;
+  }
+
+  if (failures) {
+    fprintf(stderr, "opt_kernels_check: %d failed trial(s)\n", failures);
+    return 1;
+  }
+  return 0;
+}
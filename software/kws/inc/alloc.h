@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cfg.h"
+
+// Allocator of the C++ runtime (CFG_ALLOCATOR). operator new and delete take
+// fixed-size blocks from the size-class pools of CFG_ALLOC_POOLS, in O(1)
+// and without touching the sbrk heap, so freed blocks are always reused and
+// the memory in use cannot creep over time. A request goes to the smallest
+// class it fits in, or the next one up when that class is exhausted. Per
+// inference scratch comes from a separate arena that is reset as a whole.
+// None of it may be used from interrupt handlers.
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t blocks;
+    uint32_t used;
+    uint32_t peak;          // High-water mark of used
+    uint32_t failures;      // Requests it could not serve
+    uint32_t allocations;
+    uint64_t requested;     // Bytes asked for over all allocations
+} alloc_pool_stats_t;
+
+typedef struct {
+    uint32_t size;
+    uint32_t used;
+    uint32_t peak;
+    uint32_t failures;
+} alloc_scratch_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Aligned to 8 bytes, returns NULL when the arena is full
+void *alloc_scratch(size_t size);
+
+// Frees every scratch allocation, called once per detection hop
+void alloc_scratch_reset(void);
+
+int alloc_pool_count(void);
+void alloc_pool_stats(int pool, alloc_pool_stats_t *stats);
+void alloc_scratch_stats(alloc_scratch_stats_t *stats);
+
+// Prints one CSV line per pool and one for the arena:
+//   alloc,pool,<block>,<blocks>,<used>,<peak>,<failures>,<fill %>
+//   alloc,scratch,<size>,<used>,<peak>,<failures>
+// The fill is the share of the block bytes that were asked for, the rest is
+// lost to internal fragmentation. Blocks are never split, so there is no
+// external fragmentation.
+void alloc_report(void);
+
+#ifdef __cplusplus
+}
+#endif
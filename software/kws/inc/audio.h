@@ -0,0 +1,165 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cfg.h"
+
+// Lock-free single-producer/single-consumer ring of audio samples. The
+// producer (sampling ISR on CPU0 or LPCPU) only writes head, the consumer
+// (main CPU) only writes tail. Both indices are free-running and wrap
+// through the power-of-two mask.
+typedef struct {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t overruns;
+    int16_t data[CFG_AUDIO_RING_SIZE];
+} audio_ring_t;
+
+#define AUDIO_RING_MASK (CFG_AUDIO_RING_SIZE - 1)
+
+_Static_assert((CFG_AUDIO_RING_SIZE & AUDIO_RING_MASK) == 0,
+    "CFG_AUDIO_RING_SIZE must be a power of two");
+
+// The samples beyond are dropped and counted in overruns
+_Static_assert(CFG_AUDIO_RING_SIZE >= CFG_AUDIO_LATENCY_COUNT,
+    "CFG_AUDIO_RING_SIZE cannot absorb CFG_AUDIO_LATENCY_MS of audio");
+
+// Producer ===================================================================
+
+static inline void audio_ring_push(audio_ring_t *ring, int16_t sample)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head - tail == CFG_AUDIO_RING_SIZE) {
+        ring->overruns++;
+        return;
+    }
+
+    ring->data[head & AUDIO_RING_MASK] = sample;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static inline size_t audio_ring_count(audio_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)
+        - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+// Drops the oldest samples from the producer side. Only valid while the
+// consumer is known to be stopped, the tail belongs to it otherwise.
+static inline void audio_ring_drop(audio_ring_t *ring, size_t len)
+{
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+}
+
+// Consumer ===================================================================
+
+static inline size_t audio_ring_pop(audio_ring_t *ring, int16_t *dst,
+    size_t len)
+{
+    uint32_t tail = ring->tail;
+    size_t count = audio_ring_count(ring);
+
+    if (len > count) len = count;
+
+    for (size_t i = 0; i < len; i++)
+        dst[i] = ring->data[(tail + i) & AUDIO_RING_MASK];
+
+    __atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+    return len;
+}
+
+// Ping-pong ==================================================================
+
+// Two whole windows for CFG_AUDIO_PINGPONG, the producer fills one while the
+// consumer runs the detection on the other. filled counts the windows handed
+// over by the producer, released the ones handed back by the consumer, and
+// window n lives in data[n & 1]. As with the ring, each side only writes its
+// own index.
+typedef struct {
+    uint32_t filled;
+    uint32_t released;
+    uint32_t pos;
+    uint32_t overruns;
+    uint8_t active[2];
+    int16_t data[2][CFG_AUDIO_DATA_SIZE];
+} audio_pingpong_t;
+
+// Producer ===================================================================
+
+// Returns 1 when the sample completes a window, active is then published
+// with it
+static inline int audio_pingpong_push(audio_pingpong_t *pp, int16_t sample,
+    int active)
+{
+    uint32_t filled = pp->filled;
+    uint32_t released = __atomic_load_n(&pp->released, __ATOMIC_ACQUIRE);
+
+    // Both buffers are still held by the consumer
+    if (filled - released == 2) {
+        pp->overruns++;
+        return 0;
+    }
+
+    pp->data[filled & 1][pp->pos] = sample;
+    if (++pp->pos < CFG_AUDIO_DATA_SIZE)
+        return 0;
+
+    pp->pos = 0;
+    pp->active[filled & 1] = active;
+    __atomic_store_n(&pp->filled, filled + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static inline size_t audio_pingpong_count(audio_pingpong_t *pp)
+{
+    return __atomic_load_n(&pp->filled, __ATOMIC_ACQUIRE)
+        - __atomic_load_n(&pp->released, __ATOMIC_ACQUIRE);
+}
+
+// Drops the oldest window from the producer side, same rule as
+// audio_ring_drop()
+static inline void audio_pingpong_drop(audio_pingpong_t *pp)
+{
+    uint32_t released = __atomic_load_n(&pp->released, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&pp->released, released + 1, __ATOMIC_RELEASE);
+}
+
+// Consumer ===================================================================
+
+static inline int16_t *audio_pingpong_acquire(audio_pingpong_t *pp,
+    int *active)
+{
+    uint32_t released = pp->released;
+
+    if (__atomic_load_n(&pp->filled, __ATOMIC_ACQUIRE) == released)
+        return NULL;
+
+    *active = pp->active[released & 1];
+    return pp->data[released & 1];
+}
+
+static inline void audio_pingpong_release(audio_pingpong_t *pp)
+{
+    __atomic_store_n(&pp->released, pp->released + 1, __ATOMIC_RELEASE);
+}
+
+// Capture ====================================================================
+
+size_t audio_read(int16_t *dst, size_t len);
+
+// Next whole window and whether it had activity, NULL until the producer
+// has filled one (CFG_AUDIO_PINGPONG). The window must be released once
+// it has been consumed, the producer refills it then.
+int16_t *audio_window_acquire(int *active);
+void audio_window_release(void);
+
+uint32_t audio_active_hops(void);
+uint32_t audio_overruns(void);
+
+// Feature-stride frames captured, and how many of them found CPU0 paused
+// (CFG_LPCPU and CFG_VAD)
+uint32_t audio_frames(void);
+uint32_t audio_idle_frames(void);
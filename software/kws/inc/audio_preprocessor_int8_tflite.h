@@ -1,4 +1,4 @@
-unsigned char __audio_preprocessor_int8_tflite[] = {
+alignas(16) const unsigned char __audio_preprocessor_int8_tflite[] = {
   0x1c, 0x00, 0x00, 0x00, 0x54, 0x46, 0x4c, 0x33, 0x14, 0x00, 0x20, 0x00,
   0x1c, 0x00, 0x18, 0x00, 0x14, 0x00, 0x10, 0x00, 0x0c, 0x00, 0x00, 0x00,
   0x08, 0x00, 0x04, 0x00, 0x14, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00,
@@ -731,4 +731,4 @@ unsigned char __audio_preprocessor_int8_tflite[] = {
   0x00, 0x00, 0x00, 0x20, 0x0c, 0x00, 0x00, 0x00, 0x53, 0x69, 0x67, 0x6e,
   0x61, 0x6c, 0x57, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x00, 0x00, 0x00, 0x00
 };
-unsigned int __audio_preprocessor_int8_tflite_len = 8772;
+const unsigned int __audio_preprocessor_int8_tflite_len = 8772;
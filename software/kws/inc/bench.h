@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cfg.h"
+
+// Benchmark mode (CFG_BENCHMARK). The sampling ISR replays a fixed clip
+// stored in MEM0 in place of the SPI data, so every run sees the same audio
+// with the real capture timing. Cycles are counted per stage with TIMER[1]
+// and, once the clip has been played CFG_BENCH_LOOPS times, a report is
+// printed as CSV lines (scripts/kws_bench.py):
+//   bench,<key>,<value>
+typedef enum {
+    BENCH_CAPTURE,  // Sampling ISR
+    BENCH_PREPROC,  // Feature generation
+    BENCH_SPEECH,   // Speech model invoke
+    BENCH_DECODE,   // Top category and command recognition
+    BENCH_SLEEP,    // CPU0 waiting for audio
+    BENCH_STAGES
+} bench_stage_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void bench_add(bench_stage_t stage, uint32_t cycles);
+
+// Next clip sample, from the sampling ISR
+int16_t bench_sample(void);
+
+// CPU0 woke up to look for audio
+void bench_wakeup(void);
+
+// A command was recognized
+void bench_result(int category);
+
+// The clip has been played CFG_BENCH_LOOPS times
+int bench_done(void);
+void bench_report(void);
+
+#ifdef __cplusplus
+}
+#endif
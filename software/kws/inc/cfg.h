@@ -2,6 +2,59 @@
 
 // #define CFG_LPCPU
 // #define CFG_DEEP_SLEEP
+// #define CFG_STREAMING
+// #define CFG_PROFILER
+
+// Buffer stdout in a ring drained by the UART[0] TX empty interrupt of CPU0,
+// so that printing only costs a copy. When the ring is full, the text that
+// does not fit is dropped and counted, or with CFG_STDOUT_BLOCK the writer
+// drains it by polling. The ring is flushed before CPU0 sleeps.
+// #define CFG_STDOUT_IRQ
+// #define CFG_STDOUT_BLOCK
+#define CFG_STDOUT_SIZE 1024
+
+// Also count the cycles CPU0 waits for instruction fetches, per operator,
+// with the CV32E40P IMISS event on mhpmcounter3
+// #define CFG_PROFILER_IMISS
+
+// Replay a fixed clip in place of the SPI data and print a cycle report once
+// it has been played CFG_BENCH_LOOPS times (see bench.h). The clip is built
+// from KWS_BENCH_WAV, or synthesized when it is not set.
+// #define CFG_BENCHMARK
+#define CFG_BENCH_LOOPS 1
+
+// #define CFG_OPT_KERNELS
+
+// Compute the features with the native frontend (see frontend.h) in place of
+// the audio preprocessor model. The output is the same, without the
+// interpreter and its persistent arena.
+// #define CFG_NATIVE_FRONTEND
+
+// The optimized kernels use the CV32E40P Xpulp SIMD instructions (CFG_XPULP)
+// when the target CPU is built with them: the kws CMake defines
+// ADAM_COREV_PULP from the target defines, as adam_core_cv32e40p reads it.
+// They are emitted with .insn, so the stock rv32imc toolchain is enough.
+#ifdef ADAM_COREV_PULP
+    #define CFG_XPULP
+#elif defined(CFG_XPULP)
+    #error "CFG_XPULP needs a CV32E40P CPU with COREV_PULP (ADAM_COREV_PULP)"
+#endif
+
+// The speech model layers are offloaded to Gemmini-SV (CFG_GEMMINI) on the
+// nexys_video_gmsv target, the kws CMake defines it from the target name
+
+// Power MEM2 down while the audio is silent (batch mode only). It holds the
+// scratch arena, the interpreters stay in MEM1 and resume warm. With
+// CFG_MEM_GATING_COLD they are placed in MEM2 too and rebuilt on wake-up.
+// #define CFG_MEM_GATING
+// #define CFG_MEM_GATING_COLD
+
+// Spread the inference over the three banks so instruction fetches, weight
+// reads and activations hit different fabric slaves: code stays in MEM0, the
+// models are copied to MEM1 at boot and the scratch arena goes to MEM2. The
+// hot kernel loops are grouped at the start of MEM0. See the kws.map report
+// (scripts/mem_report.py) for where everything landed.
+// #define CFG_BANK_PLACEMENT
 
 #define CFG_SAMPLE_RATE 16000
 #define CFG_FEATURE_SIZE 40
@@ -9,9 +62,75 @@
 #define CFG_FEATURE_STRIDE_MS 20
 #define CFG_FEATURE_DURATION_MS 30
 
+// Hop energy gate, sum of the squared high-passed samples (below 2^36)
 #define CFG_AUDIO_THRESHOLD 0
 #define CFG_AUDIO_HPF 32511
 
+// Capture whole windows into two buffers instead of the ring (batch mode
+// only). The sampling ISR fills one while CPU0 runs the detection on the
+// other, with no copy or slide of the window. Windows no longer overlap, the
+// hop is a whole window and the detection must keep up with it.
+// #define CFG_AUDIO_PINGPONG
+
+// Let TIMER[0] clock the samples into the SPI RX FIFO without the CPU and
+// take one interrupt per burst instead of one per sample. The burst must fit
+// in the FIFO (16 words) with room for the interrupt latency.
+// #define CFG_SPI_FIFO
+#define CFG_AUDIO_BURST 8
+
+// Voice activity detection in the sampling ISR (see vad.h), in place of the
+// CFG_AUDIO_THRESHOLD power gate. With CFG_LPCPU and CFG_DEEP_SLEEP, CPU0
+// is only woken while speech is likely, the ring keeps the latest audio.
+// #define CFG_VAD
+
+#define CFG_VAD_SNR_SHIFT 2             // Speech is 4x (6 dB) above the floor
+#define CFG_VAD_FLOOR_MIN 256           // Frame energy, s^2 >> 9 summed
+#define CFG_VAD_ZCR_MIN 4               // Zero crossings per frame
+#define CFG_VAD_ZCR_MAX 120
+#define CFG_VAD_RISE_SHIFT 4            // Floor rise time constants, frames
+#define CFG_VAD_SPEECH_RISE_SHIFT 8
+#define CFG_VAD_TRAIN 16                // Frames before the first decision
+#define CFG_VAD_ONSET 2
+#define CFG_VAD_HANGOVER_MS 500
+
+// Serve operator new and delete from size-class pools instead of the sbrk
+// heap (see alloc.h). Each pool is POOL(block bytes, blocks, bank), with
+// increasing block sizes in multiples of 16. The bank is empty for MEM1, or
+// MEM2_BSS with CFG_BANK_PLACEMENT (not CFG_MEM_GATING, MEM2 loses its
+// content) or LPMEM_DATA with CFG_LPCPU. The scratch arena is reset on
+// every detection hop.
+// #define CFG_ALLOCATOR
+#define CFG_ALLOC_POOLS \
+    POOL(16, 32, ) \
+    POOL(32, 32, ) \
+    POOL(64, 16, ) \
+    POOL(128, 8, ) \
+    POOL(256, 4, ) \
+    POOL(1024, 2, )
+#define CFG_ALLOC_SCRATCH_SIZE 4096
+#define CFG_ALLOC_SCRATCH_BANK
+
+// Tensor arena regions in bytes. The persistent regions are private to each
+// interpreter, the scratch region is shared. Tighten them with the
+// arena_used_bytes() figures printed by inference_*_init().
+#ifndef CFG_ARENA_PREPROC_PERSISTENT
+    #define CFG_ARENA_PREPROC_PERSISTENT 12288
+#endif
+#ifndef CFG_ARENA_SPEECH_PERSISTENT
+    #define CFG_ARENA_SPEECH_PERSISTENT 6144
+#endif
+#ifndef CFG_ARENA_SCRATCH
+    #ifdef CFG_GEMMINI
+        // Room for the packed FullyConnected input tiles
+        #define CFG_ARENA_SCRATCH 28672
+    #else
+        #define CFG_ARENA_SCRATCH 12288
+    #endif
+#endif
+
+// Number of detection hops between two per-operator profile dumps
+#define CFG_PROFILER_PERIOD 16
+
 #define CFG_FEATURE_ELEMENT_COUNT \
     (CFG_FEATURE_SIZE * CFG_FEATURE_COUNT)
 #define CFG_AUDIO_DURATION_COUNT \
@@ -21,6 +140,96 @@
 #define CFG_AUDIO_DATA_SIZE \
     ((CFG_FEATURE_COUNT - 1) * CFG_AUDIO_STRIDE_COUNT \
     + CFG_AUDIO_DURATION_COUNT)
+#define CFG_AUDIO_OVERLAP_COUNT \
+    (CFG_AUDIO_DURATION_COUNT - CFG_AUDIO_STRIDE_COUNT)
+#define CFG_AUDIO_LATENCY_COUNT \
+    (CFG_AUDIO_LATENCY_MS * CFG_SAMPLE_RATE / 1000)
+
+// Streaming mode captures one feature frame at a time and keeps a rolling
+// window of features, batch mode captures the whole window at once.
+#ifdef CFG_STREAMING
+    #define CFG_AUDIO_CAPTURE_SIZE CFG_AUDIO_DURATION_COUNT
+#else
+    #define CFG_AUDIO_CAPTURE_SIZE CFG_AUDIO_DATA_SIZE
+#endif
+
+// Number of new samples between two detections, the rest of the window
+// overlaps with the previous one. Must be a multiple of the feature stride.
+#ifdef CFG_STREAMING
+    #define CFG_AUDIO_WINDOW_HOP CFG_AUDIO_STRIDE_COUNT
+#elif defined(CFG_AUDIO_PINGPONG)
+    #define CFG_AUDIO_WINDOW_HOP CFG_AUDIO_DATA_SIZE
+#else
+    #define CFG_AUDIO_WINDOW_HOP (25 * CFG_AUDIO_STRIDE_COUNT)
+#endif
+
+// Posterior smoothing, as TFLM's RecognizeCommands. The durations are turned
+// into a number of speech runs, one per hop. The threshold is in output
+// quantization steps above the zero point (1/256 for the int8 softmax).
+#define CFG_RECOGNIZE_AVERAGE_MS 1000
+#define CFG_RECOGNIZE_SUPPRESSION_MS 1500
+#define CFG_RECOGNIZE_THRESHOLD 200
+
+// Speech model cascade (see inference.h). The registered model
+// CFG_SPEECH_CASCADE_GATE runs on every hop and the selected model only when
+// the top category of the gate is a keyword scoring more than
+// CFG_SPEECH_CASCADE_THRESHOLD steps above the zero point.
+// #define CFG_SPEECH_CASCADE
+#define CFG_SPEECH_CASCADE_GATE 0
+#define CFG_SPEECH_CASCADE_THRESHOLD 64
+
+#define CFG_AUDIO_WINDOW_HOP_MS \
+    (CFG_AUDIO_WINDOW_HOP * 1000 / CFG_SAMPLE_RATE)
+#define CFG_RECOGNIZE_AVERAGE_COUNT \
+    ((CFG_RECOGNIZE_AVERAGE_MS + CFG_AUDIO_WINDOW_HOP_MS - 1) \
+    / CFG_AUDIO_WINDOW_HOP_MS)
+#define CFG_RECOGNIZE_SUPPRESSION_COUNT \
+    (CFG_RECOGNIZE_SUPPRESSION_MS / CFG_AUDIO_WINDOW_HOP_MS)
+#define CFG_RECOGNIZE_MIN_COUNT \
+    (CFG_RECOGNIZE_AVERAGE_COUNT < 3 ? CFG_RECOGNIZE_AVERAGE_COUNT : 3)
+
+// Keep waking CPU0 for a whole hop after the last speech frame, so the
+// window holding the end of a word is evaluated
+#define CFG_VAD_HANGOVER \
+    ((CFG_VAD_HANGOVER_MS > CFG_AUDIO_WINDOW_HOP_MS ? \
+    CFG_VAD_HANGOVER_MS : CFG_AUDIO_WINDOW_HOP_MS) / CFG_FEATURE_STRIDE_MS)
+
+// Worst-case time CPU0 spends away from the capture ring on a detection hop
+// (preprocessor and speech model runs), in milliseconds. Measure it with the
+// inference_*_run cycle figures.
+#define CFG_AUDIO_LATENCY_MS 400
+
+// Capture ring size in samples (power of two). It must absorb the audio that
+// arrives during CFG_AUDIO_LATENCY_MS, which audio.h checks. The ring is in
+// MEM1 with the LPCPU too, as the ping-pong buffers: LPMEM is too small for
+// it and MEM1 stays powered while CPU0 sleeps.
+#define CFG_AUDIO_RING_SIZE 8192
+
+#if defined(CFG_MEM_GATING_COLD) && !defined(CFG_MEM_GATING)
+    #define CFG_MEM_GATING
+#endif
+
+#if defined(CFG_AUDIO_PINGPONG) && defined(CFG_STREAMING)
+    #error "CFG_AUDIO_PINGPONG captures whole windows, use the ring"
+#endif
+
+#if defined(CFG_MEM_GATING) && defined(CFG_STREAMING)
+    #error "CFG_MEM_GATING needs the scratch arena between two frames"
+#endif
+
+#if defined(CFG_MEM_GATING) || defined(CFG_BANK_PLACEMENT)
+    #define MEM2_BSS __attribute__((section(".mem2.bss")))
+#else
+    #define MEM2_BSS
+#endif
+
+#ifdef CFG_BANK_PLACEMENT
+    #define MODEL_DATA __attribute__((section(".mem1.rodata")))
+    #define HOT_TEXT __attribute__((section(".text.hot")))
+#else
+    #define MODEL_DATA
+    #define HOT_TEXT
+#endif
 
 #ifdef CFG_LPCPU
     #define LPMEM_TEXT __attribute__((section(".lpmem.text")))
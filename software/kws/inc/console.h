@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cfg.h"
+
+// Buffered stdout (CFG_STDOUT_IRQ). _write() copies the text into a ring
+// that the UART[0] TX empty interrupt drains one character at a time on
+// CPU0. Without CFG_LPCPU the interrupt comes through the sampling handler,
+// which calls console_irq() first.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Queues len characters and returns len, including what was dropped
+size_t console_write(const char *buf, size_t len);
+
+// Waits until the ring is empty and the UART has taken the last character.
+// Called before CPU0 sleeps, nothing is sent while it is down.
+void console_flush(void);
+
+// Characters dropped on a full ring since boot
+uint32_t console_dropped(void);
+
+// TX empty interrupt
+void console_irq(void);
+
+#ifdef __cplusplus
+}
+#endif
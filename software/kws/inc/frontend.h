@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "cfg.h"
+
+// Native audio frontend (CFG_NATIVE_FRONTEND). It computes the int8 feature
+// frame of the audio preprocessor model in one pass over a 30 ms frame, with
+// no interpreter and no arena, and matches its output bit for bit. The
+// parameters and tables are generated from the model (scripts/gen_frontend.py)
+// and the checks of host/frontend_check.cpp compare both on the host.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Prepares the FFT, returns 0 or -1 when its state does not fit
+int frontend_init(void);
+
+// Clears the noise estimate, as a new interpreter of the model would
+void frontend_reset(void);
+
+// Converts CFG_AUDIO_DURATION_COUNT samples to CFG_FEATURE_SIZE features
+void frontend_run(const int16_t* audio_frame, int8_t* features);
+
+#ifdef __cplusplus
+}
+#endif
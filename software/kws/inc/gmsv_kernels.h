@@ -0,0 +1,12 @@
+#pragma once
+
+#include "tensorflow/lite/micro/micro_common.h"
+
+// int8 FullyConnected, Conv2D and DepthwiseConv2D kernels offloaded to the
+// Gemmini-SV systolic array of the nexys_video_gmsv target. Convolutions are
+// lowered to matrix products through im2col. Shapes the array cannot take,
+// and every layer when the array fails its self-test, run on the reference
+// kernels.
+TFLMRegistration Register_FULLY_CONNECTED_GMSV();
+TFLMRegistration Register_CONV_2D_GMSV();
+TFLMRegistration Register_DEPTHWISE_CONV_2D_GMSV();
@@ -10,19 +10,8 @@ extern void lpcpu_start(void);
 
 // UART[0] ====================================================================
 
-static inline void hal_uart0_init(void)
-{
-    RAL.SYSCFG->LSPA.UART[0].MR = 1;
-    while (RAL.SYSCFG->LSPA.UART[0].MR);
-
-    RAL.LSPA.UART[0]->BRR = SYSTEM_CLOCK / 115200;
-
-    RAL.LSPA.UART[0]->TE = 1;
-    RAL.LSPA.UART[0]->RE = 1;
-    RAL.LSPA.UART[0]->DL = 8;
-
-    RAL.LSPA.UART[0]->PE = 1;
-}
+// In hal.cpp, with the register descriptors of adam_ral.hpp
+void hal_uart0_init(void);
 
 static inline void hal_uart0_write(const char *buf, size_t len)
 {
@@ -32,25 +21,27 @@ static inline void hal_uart0_write(const char *buf, size_t len)
     }
 }
 
-// SPI[0] =====================================================================
+static inline int hal_uart0_tx_ready(void)
+{
+    return RAL.LSPA.UART[0]->TBE;
+}
 
-static inline void hal_spi0_init(void)
+// Only valid when hal_uart0_tx_ready()
+static inline void hal_uart0_tx_put(char c)
 {
-    RAL.SYSCFG->LSPA.SPI[0].MR = 1;
-    while (RAL.SYSCFG->LSPA.SPI[0].MR);
+    RAL.LSPA.UART[0]->DR = c;
+}
 
-    RAL.LSPA.SPI[0]->MS = 1;
-    RAL.LSPA.SPI[0]->CPHA = 0;
-    RAL.LSPA.SPI[0]->CPOL = 0;
-    RAL.LSPA.SPI[0]->DO = 1;
-    RAL.LSPA.SPI[0]->DL = 15;
+// The TX empty interrupt stays asserted while enabled and the buffer empty
+static inline void hal_uart0_tx_irq(int enable)
+{
+    RAL.LSPA.UART[0]->TBEIE = enable;
+}
 
-    RAL.LSPA.SPI[0]->BRR = SYSTEM_CLOCK / 1000000;
+// SPI[0] =====================================================================
 
-    RAL.LSPA.SPI[0]->PE = 1;
-    RAL.LSPA.SPI[0]->TE = 1;
-    RAL.LSPA.SPI[0]->RE = 1;
-}
+// In hal.cpp
+void hal_spi0_init(void);
 
 static inline int32_t hal_spi0_read(void)
 {
@@ -61,6 +52,26 @@ static inline int32_t hal_spi0_read(void)
     return RAL.LSPA.SPI[0]->DR;
 }
 
+static inline size_t hal_spi0_rx_count(void)
+{
+    return RAL.LSPA.SPI[0]->RXL;
+}
+
+// Only valid for the hal_spi0_rx_count() words present
+static inline int16_t hal_spi0_rx_pop(void)
+{
+    return RAL.LSPA.SPI[0]->DR;
+}
+
+// Returns and clears the dropped trigger flag
+static inline int hal_spi0_rx_overrun(void)
+{
+    if (!RAL.LSPA.SPI[0]->ROV) return 0;
+
+    RAL.LSPA.SPI[0]->ROV = 1;
+    return 1;
+}
+
 // TIMER[0] ===================================================================
 
 static inline void hal_timer0_init(void)
@@ -71,7 +82,11 @@ static inline void hal_timer0_init(void)
     RAL.LSPA.TIMER[0]->PR = SYSTEM_CLOCK / CFG_SAMPLE_RATE;
     RAL.LSPA.TIMER[0]->VR = 0;
     RAL.LSPA.TIMER[0]->ARR = 0;
+#ifdef CFG_SPI_FIFO
+    RAL.LSPA.TIMER[0]->IER = 0;
+#else
     RAL.LSPA.TIMER[0]->IER = 1;
+#endif
 }
 
 static inline void hal_timer0_start(void)
@@ -107,6 +122,26 @@ static inline uint32_t hal_timer1_read(void)
     return RAL.LSPA.TIMER[1]->VR;
 }
 
+// HPM ========================================================================
+
+// CV32E40P event of mhpmevent3 counting the cycles spent waiting for
+// instruction fetches (excluding jumps and branches)
+#define HAL_HPM_IMISS (1 << 4)
+
+static inline void hal_hpm3_init(uint32_t event)
+{
+    asm volatile("csrw 0x323, %0" : : "r"(event));      // mhpmevent3
+    asm volatile("csrw 0xB03, zero");                   // mhpmcounter3
+    asm volatile("csrc 0x320, %0" : : "r"(1 << 3));     // mcountinhibit
+}
+
+static inline uint32_t hal_hpm3_read(void)
+{
+    uint32_t value;
+    asm volatile("csrr %0, 0xB03" : "=r"(value));
+    return value;
+}
+
 // LPMEM ======================================================================
 
 static inline void hal_lpmem_init(void)
@@ -115,6 +150,44 @@ static inline void hal_lpmem_init(void)
     while (RAL.SYSCFG->LPMEM.MR);
 }
 
+// MEM ========================================================================
+
+static inline void hal_mem2_resume(void)
+{
+    RAL.SYSCFG->MEM[2].MR = 1;
+    while (RAL.SYSCFG->MEM[2].MR);
+}
+
+// Powers MEM2 down, its content is lost
+static inline void hal_mem2_stop(void)
+{
+    RAL.SYSCFG->MEM[2].MR = 3;
+    while (RAL.SYSCFG->MEM[2].MR);
+}
+
+// IRQ ========================================================================
+
+#define HAL_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+// Bit of UART[0] in the syscfg interrupt enables. The LSPA peripherals come
+// first, as GPIO, SPI, TIMER and UART.
+#define HAL_IRQ_UART0 \
+    (1u << (HAL_COUNT(RAL.LSPA.GPIO) + HAL_COUNT(RAL.LSPA.SPI) \
+    + HAL_COUNT(RAL.LSPA.TIMER)))
+
+// Masks the interrupts of the calling core, returns the mstatus to restore
+static inline uint32_t hal_irq_save(void)
+{
+    uint32_t mstatus;
+    asm volatile("csrrc %0, mstatus, 8" : "=r"(mstatus) : : "memory");
+    return mstatus;
+}
+
+static inline void hal_irq_restore(uint32_t mstatus)
+{
+    asm volatile("csrs mstatus, %0" : : "r"(mstatus & 8) : "memory");
+}
+
 // CPU ========================================================================
 
 static inline void hal_cpu0_resume(void)
@@ -125,6 +198,15 @@ static inline void hal_cpu0_resume(void)
     while (RAL.SYSCFG->CPU[0].MR);
 }
 
+// Non-blocking variant of hal_cpu0_resume(), does nothing if CPU0 is running
+static inline void hal_cpu0_wake(void)
+{
+    if (!RAL.SYSCFG->CPU[0].SR) return;
+
+    RAL.SYSCFG->CPU[0].MR = 1;
+    while (RAL.SYSCFG->CPU[0].MR);
+}
+
 static inline void hal_cpu0_enable_irq(void)
 {
     RAL.SYSCFG->CPU[0].IER = ~0;
@@ -134,12 +216,18 @@ static inline void hal_cpu0_enable_irq(void)
 
 static inline void hal_lpcpu_resume(void)
 {
-    RAL.SYSCFG->LPCPU.BAR = (uint32_t) lpcpu_start;
+    RAL.SYSCFG->LPCPU.BAR = (uint32_t) (uintptr_t) lpcpu_start;
     RAL.SYSCFG->LPCPU.MR = 1;
     while (RAL.SYSCFG->LPCPU.MR);
 }
 
 static inline void hal_lpcpu_enable_irq(void)
 {
+#ifdef CFG_STDOUT_IRQ
+    // The LPCPU samples, CPU0 drains stdout
+    RAL.SYSCFG->LPCPU.IER = ~HAL_IRQ_UART0;
+    RAL.SYSCFG->CPU[0].IER = HAL_IRQ_UART0;
+#else
     RAL.SYSCFG->LPCPU.IER = ~0;
+#endif
 }
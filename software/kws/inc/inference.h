@@ -2,6 +2,11 @@
 
 #include "cfg.h"
 
+// inference_speech_run() returns a keyword category index when a new command
+// is recognized, never silence or unknown, or one of these codes
+#define INFERENCE_ERROR (-1)
+#define INFERENCE_NO_COMMAND (-2)
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -9,8 +14,38 @@ extern "C" {
 void inference_preproc_init(void);
 void inference_speech_init(void);
 void inference_preproc_run(int16_t* audio_data, const size_t audio_data_size);
+void inference_preproc_step(const int16_t* audio_frame);
+int inference_preproc_ready(void);
 int inference_speech_run(void);
 
+// Called before the bank holding the inference state is stopped and after
+// it is powered again (CFG_MEM_GATING). inference_resume() returns once both
+// interpreters can run, rebuilding them if their state was lost.
+void inference_suspend(void);
+void inference_resume(void);
+
+// Speech model registry. inference_speech_init() builds every model, each
+// with its own interpreter, and inference_speech_run() runs the selected one
+// on the current feature window. Selecting another model keeps the features
+// and restarts the smoothing, it returns INFERENCE_ERROR for an unknown
+// index. With CFG_SPEECH_CASCADE, the gate model runs first and the selected
+// one only on a keyword.
+int inference_speech_model_count(void);
+const char* inference_speech_model_name(int model);
+int inference_speech_select(int model);
+int inference_speech_selected(void);
+
+// Unsmoothed top category of the last inference_speech_run(), the categories
+// are those of the selected model
+int inference_speech_top(void);
+int inference_category_count(void);
+const char* inference_category_label(int category);
+
+#ifdef CFG_PROFILER
+void inference_profile_dump(void);
+void inference_profile_reset(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cfg.h"
+
+// Block audio ingest: the capture high-pass filter and the energy of the
+// filtered samples, without 64-bit arithmetic. Callable from the sampling
+// ISR on CPU0 or the LPCPU.
+
+// One-pole high-pass filter state, y[n] = x[n] - x[n-1] + R*y[n-1]
+typedef struct {
+    int16_t prev_in;
+    int32_t prev_out;
+} ingest_hpf_t;
+
+// Energies are sums of y^2 >> 4, so up to 63 full-scale samples fit in 32
+// bits. Longer sums are kept with a block exponent, value = mant << exp.
+#define INGEST_ENERGY_SHIFT 4
+
+typedef struct {
+    uint32_t mant;
+    uint32_t exp;
+} ingest_power_t;
+
+// Filters n samples of in into out and returns sum(out^2 >> 4), saturated to
+// 32 bits. out may alias in.
+uint32_t ingest_block(ingest_hpf_t *hpf, const int16_t *in, int16_t *out,
+    size_t n);
+
+void ingest_power_add(ingest_power_t *power, uint32_t energy);
+
+// power >= threshold, both in units of y^2 >> 4
+int ingest_power_ge(const ingest_power_t *power, uint32_t threshold);
+
+static inline void ingest_power_reset(ingest_power_t *power)
+{
+    power->mant = 0;
+    power->exp = 0;
+}
@@ -1,4 +1,4 @@
-unsigned char __micro_speech_quantized_tflite[] = {
+alignas(16) const unsigned char __micro_speech_quantized_tflite[] = {
   0x20, 0x00, 0x00, 0x00, 0x54, 0x46, 0x4c, 0x33, 0x00, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x12, 0x00, 0x1c, 0x00, 0x04, 0x00, 0x08, 0x00, 0x0c, 0x00,
   0x10, 0x00, 0x14, 0x00, 0x00, 0x00, 0x18, 0x00, 0x12, 0x00, 0x00, 0x00,
@@ -1567,4 +1567,4 @@ unsigned char __micro_speech_quantized_tflite[] = {
   0x0c, 0x00, 0x07, 0x00, 0x00, 0x00, 0x08, 0x00, 0x0a, 0x00, 0x00, 0x00,
   0x00, 0x00, 0x00, 0x04, 0x03, 0x00, 0x00, 0x00
 };
-unsigned int __micro_speech_quantized_tflite_len = 18800;
+const unsigned int __micro_speech_quantized_tflite_len = 18800;
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "tensorflow/lite/micro/micro_common.h"
+
+// int8 FullyConnected and DepthwiseConv2D kernels tuned for the RV32 cores.
+// They reuse the reference Init/Prepare, produce bit-exact results and hand
+// the shapes and types they do not cover back to the reference kernels.
+TFLMRegistration Register_FULLY_CONNECTED_OPT();
+TFLMRegistration Register_DEPTHWISE_CONV_2D_OPT();
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "cfg.h"
+
+#include "tensorflow/lite/micro/compatibility.h"
+#include "tensorflow/lite/micro/micro_profiler_interface.h"
+
+// Per-operator cycle profiler backed by TIMER[1]. The interpreter opens one
+// event per operator invoke, tagged with the operator name, and the cycles
+// are accumulated per tag. With CFG_PROFILER_IMISS, the instruction fetch
+// stall cycles of mhpmcounter3 are accumulated as well.
+class CycleProfiler : public tflite::MicroProfilerInterface {
+ public:
+  explicit CycleProfiler(const char* name) : name_(name) {}
+
+  uint32_t BeginEvent(const char* tag) override;
+  void EndEvent(uint32_t event_handle) override;
+
+  // Print one CSV line per operator: profile,<model>,<op>,<calls>,<cycles>
+  // followed by ,<imiss> with CFG_PROFILER_IMISS
+  void Dump() const;
+  void Reset();
+
+ private:
+  static constexpr uint32_t kMaxTags = 24;
+
+  struct Entry {
+    const char* tag;
+    uint32_t calls;
+    uint32_t cycles;
+    uint32_t start;
+#ifdef CFG_PROFILER_IMISS
+    uint32_t imiss;
+    uint32_t imiss_start;
+#endif
+  };
+
+  const char* name_;
+  Entry entries_[kMaxTags] = {};
+  uint32_t count_ = 0;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
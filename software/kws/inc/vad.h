@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include "cfg.h"
+
+// Fixed-point voice activity detector, cheap enough for the sampling ISR on
+// the LPCPU. The high-passed samples are cut into frames of one feature
+// stride. A frame is speech when its energy is CFG_VAD_SNR_SHIFT octaves
+// above an adaptive noise floor and its zero-crossing count is in the range
+// of voiced and fricative sounds, which rejects hum and hiss. The detector
+// turns active after CFG_VAD_ONSET speech frames and stays active for
+// CFG_VAD_HANGOVER frames after the last one.
+typedef struct {
+    uint32_t energy;
+    uint32_t floor;
+    int16_t prev;
+    uint16_t count;
+    uint16_t crossings;
+    uint16_t frames;
+    uint16_t onset;
+    uint16_t hangover;
+} vad_t;
+
+// Feeds one high-passed sample, returns non-zero while speech is likely
+int vad_push(vad_t *vad, int16_t sample);
+
+static inline int vad_active(const vad_t *vad)
+{
+    return vad->hangover != 0;
+}
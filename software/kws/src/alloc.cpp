@@ -0,0 +1,236 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+
+#include "alloc.h"
+#include "cfg.h"
+
+#ifdef CFG_ALLOCATOR
+
+namespace {
+
+// Fixed-size blocks. Freed blocks are threaded on an intrusive free list,
+// blocks never used yet are taken in order past a watermark, so the storage
+// needs no initialization. MEM2 is not zeroed, and new may run from the
+// static constructors before main().
+class FixedPool {
+ public:
+  constexpr FixedPool(uint8_t* storage, uint32_t block_size, uint32_t blocks)
+      : storage_(storage), block_size_(block_size), blocks_(blocks) {}
+
+  void* Allocate(size_t size) {
+    void* block;
+    if (free_) {
+      block = free_;
+      free_ = free_->next;
+    } else if (untouched_ < blocks_) {
+      block = storage_ + untouched_++ * block_size_;
+    } else {
+      failures_++;
+      return nullptr;
+    }
+
+    if (++used_ > peak_) peak_ = used_;
+    allocations_++;
+    requested_ += size;
+    return block;
+  }
+
+  void Free(void* p) {
+    Block* block = static_cast<Block*>(p);
+    block->next = free_;
+    free_ = block;
+    used_--;
+  }
+
+  bool Owns(const void* p) const {
+    const uint8_t* byte = static_cast<const uint8_t*>(p);
+    return byte >= storage_ && byte < storage_ + block_size_ * blocks_;
+  }
+
+  uint32_t block_size() const { return block_size_; }
+
+  void Stats(alloc_pool_stats_t* stats) const {
+    stats->block_size = block_size_;
+    stats->blocks = blocks_;
+    stats->used = used_;
+    stats->peak = peak_;
+    stats->failures = failures_;
+    stats->allocations = allocations_;
+    stats->requested = requested_;
+  }
+
+ private:
+  struct Block {
+    Block* next;
+  };
+
+  uint8_t* storage_;
+  uint32_t block_size_;
+  uint32_t blocks_;
+  Block* free_ = nullptr;
+  uint32_t untouched_ = 0;
+  uint32_t used_ = 0;
+  uint32_t peak_ = 0;
+  uint32_t failures_ = 0;
+  uint32_t allocations_ = 0;
+  uint64_t requested_ = 0;
+};
+
+// Bump allocator released as a whole
+class ScratchArena {
+ public:
+  constexpr ScratchArena(uint8_t* storage, uint32_t size)
+      : storage_(storage), size_(size) {}
+
+  void* Allocate(size_t size) {
+    const uint32_t start = (used_ + 7) & ~7u;
+    if (start > size_ || size > size_ - start) {
+      failures_++;
+      return nullptr;
+    }
+    used_ = start + size;
+    if (used_ > peak_) peak_ = used_;
+    return storage_ + start;
+  }
+
+  void Reset() { used_ = 0; }
+
+  void Stats(alloc_scratch_stats_t* stats) const {
+    stats->size = size_;
+    stats->used = used_;
+    stats->peak = peak_;
+    stats->failures = failures_;
+  }
+
+ private:
+  uint8_t* storage_;
+  uint32_t size_;
+  uint32_t used_ = 0;
+  uint32_t peak_ = 0;
+  uint32_t failures_ = 0;
+};
+
+// Blocks of 16 bytes and up keep every allocation aligned like malloc()
+#define POOL(block, count, bank) block,
+constexpr uint32_t kBlockSizes[] = {CFG_ALLOC_POOLS};
+#undef POOL
+
+constexpr bool ValidBlockSizes(void) {
+  for (size_t i = 0; i < std::size(kBlockSizes); i++) {
+    if (kBlockSizes[i] % 16 != 0) return false;
+    if (i > 0 && kBlockSizes[i] <= kBlockSizes[i - 1]) return false;
+  }
+  return true;
+}
+
+static_assert(ValidBlockSizes(),
+              "CFG_ALLOC_POOLS must list increasing multiples of 16 bytes");
+
+#define POOL(block, count, bank) \
+  alignas(16) uint8_t bank g_pool_##block[(block) * (count)];
+CFG_ALLOC_POOLS
+#undef POOL
+
+#define POOL(block, count, bank) FixedPool(g_pool_##block, block, count),
+FixedPool g_pools[] = {CFG_ALLOC_POOLS};
+#undef POOL
+
+constexpr int kPoolCount = std::size(g_pools);
+
+alignas(16) uint8_t CFG_ALLOC_SCRATCH_BANK
+    g_scratch_storage[CFG_ALLOC_SCRATCH_SIZE];
+ScratchArena g_scratch(g_scratch_storage, CFG_ALLOC_SCRATCH_SIZE);
+
+// Smallest class that fits, then the larger ones when it is exhausted
+void* Allocate(size_t size) {
+  if (size == 0) size = 1;
+  for (FixedPool& pool : g_pools) {
+    if (size > pool.block_size()) continue;
+    if (void* p = pool.Allocate(size)) return p;
+  }
+  return nullptr;
+}
+
+void* AllocateOrDie(size_t size) {
+  void* p = Allocate(size);
+  if (!p) {
+    // There are no exceptions to report it with
+    printf("alloc: no block left for %u bytes\n", (unsigned) size);
+    abort();
+  }
+  return p;
+}
+
+void Free(void* p) {
+  if (!p) return;
+  for (FixedPool& pool : g_pools) {
+    if (pool.Owns(p)) {
+      pool.Free(p);
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return AllocateOrDie(size); }
+void* operator new[](size_t size) { return AllocateOrDie(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return Allocate(size);
+}
+
+void operator delete(void* p) noexcept { Free(p); }
+void operator delete[](void* p) noexcept { Free(p); }
+void operator delete(void* p, size_t) noexcept { Free(p); }
+void operator delete[](void* p, size_t) noexcept { Free(p); }
+
+extern "C" void* alloc_scratch(size_t size) {
+  return g_scratch.Allocate(size);
+}
+
+extern "C" void alloc_scratch_reset(void) {
+  g_scratch.Reset();
+}
+
+extern "C" int alloc_pool_count(void) {
+  return kPoolCount;
+}
+
+extern "C" void alloc_pool_stats(int pool, alloc_pool_stats_t* stats) {
+  if (pool < 0 || pool >= kPoolCount) return;
+  g_pools[pool].Stats(stats);
+}
+
+extern "C" void alloc_scratch_stats(alloc_scratch_stats_t* stats) {
+  g_scratch.Stats(stats);
+}
+
+extern "C" void alloc_report(void) {
+  for (int i = 0; i < kPoolCount; i++) {
+    alloc_pool_stats_t stats;
+    g_pools[i].Stats(&stats);
+    const uint64_t granted =
+        static_cast<uint64_t>(stats.allocations) * stats.block_size;
+    const unsigned fill =
+        granted ? static_cast<unsigned>(stats.requested * 100 / granted) : 0;
+    printf("alloc,pool,%u,%u,%u,%u,%u,%u\n", (unsigned) stats.block_size,
+           (unsigned) stats.blocks, (unsigned) stats.used,
+           (unsigned) stats.peak, (unsigned) stats.failures, fill);
+  }
+
+  alloc_scratch_stats_t scratch;
+  g_scratch.Stats(&scratch);
+  printf("alloc,scratch,%u,%u,%u,%u\n", (unsigned) scratch.size,
+         (unsigned) scratch.used, (unsigned) scratch.peak,
+         (unsigned) scratch.failures);
+}
+
+#endif
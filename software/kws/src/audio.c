@@ -0,0 +1,223 @@
+#include "audio.h"
+#include "bench.h"
+#include "console.h"
+#include "hal.h"
+#include "ingest.h"
+#include "vad.h"
+
+// Too large for LPMEM, MEM1 stays powered while CPU0 sleeps
+#ifdef CFG_AUDIO_PINGPONG
+static audio_pingpong_t audio_pp;
+#else
+static audio_ring_t audio_ring;
+#endif
+static volatile uint32_t LPMEM_DATA audio_hops;
+static volatile uint32_t LPMEM_DATA audio_frame_count;
+static volatile uint32_t LPMEM_DATA audio_idle_count;
+
+#ifdef CFG_AUDIO_PINGPONG
+int16_t *audio_window_acquire(int *active)
+{
+    return audio_pingpong_acquire(&audio_pp, active);
+}
+
+void audio_window_release(void)
+{
+    audio_pingpong_release(&audio_pp);
+}
+#else
+size_t audio_read(int16_t *dst, size_t len)
+{
+    return audio_ring_pop(&audio_ring, dst, len);
+}
+#endif
+
+uint32_t audio_active_hops(void)
+{
+    return audio_hops;
+}
+
+uint32_t audio_overruns(void)
+{
+#ifdef CFG_AUDIO_PINGPONG
+    return audio_pp.overruns;
+#else
+    return audio_ring.overruns;
+#endif
+}
+
+uint32_t audio_frames(void)
+{
+    return audio_frame_count;
+}
+
+uint32_t audio_idle_frames(void)
+{
+    return audio_idle_count;
+}
+
+// Sampling ===================================================================
+
+static ingest_hpf_t LPMEM_DATA hpf;
+#ifndef CFG_AUDIO_PINGPONG
+static uint32_t LPMEM_DATA power_count = 0;
+#endif
+static uint32_t LPMEM_DATA frame_count = 0;
+#ifdef CFG_VAD
+static vad_t LPMEM_DATA vad;
+static int LPMEM_DATA hop_active = 0;
+#else
+static ingest_power_t LPMEM_DATA power;
+
+#define AUDIO_POWER_THRESHOLD \
+    ((uint32_t) (CFG_AUDIO_THRESHOLD >> INGEST_ENERGY_SHIFT))
+#endif
+
+// Samples per ingest block, one SPI burst
+#ifdef CFG_SPI_FIFO
+#define AUDIO_BLOCK CFG_AUDIO_BURST
+#else
+#define AUDIO_BLOCK 1
+#endif
+
+// Takes up to AUDIO_BLOCK samples. The high-pass filter and the energy run
+// on the whole block, the energy of a block counts for the hop it starts in.
+static void LPMEM_TEXT audio_block(const int16_t *in, size_t n, int idle)
+{
+    int16_t s[AUDIO_BLOCK];
+
+#ifdef CFG_VAD
+    ingest_block(&hpf, in, s, n);
+#else
+    ingest_power_add(&power, ingest_block(&hpf, in, s, n));
+    int active = ingest_power_ge(&power, AUDIO_POWER_THRESHOLD);
+#endif
+
+    for (size_t i = 0; i < n; i++) {
+#ifdef CFG_VAD
+        hop_active |= vad_push(&vad, s[i]);
+        int active = hop_active;
+#endif
+
+        if (++frame_count == CFG_AUDIO_STRIDE_COUNT) {
+            audio_frame_count++;
+            if (idle) audio_idle_count++;
+            frame_count = 0;
+        }
+
+#ifdef CFG_AUDIO_PINGPONG
+        // CPU0 stays paused during silence, drop the oldest window so the
+        // latest one is ready when speech wakes it up
+        if (idle && audio_pingpong_count(&audio_pp) == 2)
+            audio_pingpong_drop(&audio_pp);
+
+        // Each window is one hop and carries its own activity
+        int hop_end = audio_pingpong_push(&audio_pp, in[i], active);
+#else
+        // CPU0 stays paused during silence, drop the oldest sample so the
+        // ring holds the latest audio when speech wakes it up
+        if (idle && audio_ring_count(&audio_ring) == CFG_AUDIO_RING_SIZE)
+            audio_ring_drop(&audio_ring, 1);
+
+        audio_ring_push(&audio_ring, in[i]);
+
+        int hop_end = ++power_count == CFG_AUDIO_WINDOW_HOP;
+        if (hop_end) power_count = 0;
+#endif
+
+        // Publish the activity of every hop, the consumer compares counts
+        if (hop_end) {
+            if (active) audio_hops++;
+#ifdef CFG_VAD
+            hop_active = 0;
+#else
+            ingest_power_reset(&power);
+            active = AUDIO_POWER_THRESHOLD == 0;
+#endif
+        }
+    }
+}
+
+// IRQ ========================================================================
+
+#ifdef CFG_BENCHMARK
+// The SPI is still read to keep the capture timing, the clip replaces its data
+#define AUDIO_INPUT(x) ((void) (x), bench_sample())
+#else
+#define AUDIO_INPUT(x) (x)
+#endif
+
+void __attribute__((interrupt)) LPMEM_TEXT
+#ifdef CFG_LPCPU
+    lpcpu_handler(void)
+#else
+    default_handler(void)
+#endif
+{
+#if defined(CFG_STDOUT_IRQ) && !defined(CFG_LPCPU)
+    // CPU0 takes every interrupt, stdout first as it does not return early
+    console_irq();
+#endif
+
+#ifdef CFG_SPI_FIFO
+    if(!RAL.LSPA.SPI[0]->RWM) return;
+#else
+    if(!RAL.LSPA.TIMER[0]->ER) return;
+    RAL.LSPA.TIMER[0]->ER = ~0;
+#endif
+
+#ifdef CFG_BENCHMARK
+    uint32_t t0 = hal_timer1_read();
+#endif
+
+#if defined(CFG_LPCPU) && defined(CFG_VAD)
+    int idle = RAL.SYSCFG->CPU[0].SR != 0;
+#else
+    int idle = 0;
+#endif
+
+#ifdef CFG_SPI_FIFO
+    // Drain the burst that TIMER[0] clocked in, samples dropped on a full
+    // FIFO count as ring overruns
+    int16_t in[AUDIO_BLOCK];
+    size_t n = hal_spi0_rx_count();
+
+    while (n) {
+        size_t len = n < AUDIO_BLOCK ? n : AUDIO_BLOCK;
+        for (size_t i = 0; i < len; i++)
+            in[i] = AUDIO_INPUT(hal_spi0_rx_pop());
+        audio_block(in, len, idle);
+        n -= len;
+    }
+
+#ifdef CFG_AUDIO_PINGPONG
+    if (hal_spi0_rx_overrun()) audio_pp.overruns++;
+#else
+    if (hal_spi0_rx_overrun()) audio_ring.overruns++;
+#endif
+#else
+    int16_t in = AUDIO_INPUT(hal_spi0_read());
+    audio_block(&in, 1, idle);
+#endif
+
+#ifdef CFG_LPCPU
+    // Hand the samples over to CPU0 before the ring overflows, with the VAD
+    // only while speech is likely
+#ifdef CFG_VAD
+    int wake = vad_active(&vad);
+#else
+    int wake = 1;
+#endif
+#ifdef CFG_AUDIO_PINGPONG
+    if (wake && audio_pingpong_count(&audio_pp))
+        hal_cpu0_wake();
+#else
+    if (wake && audio_ring_count(&audio_ring) >= CFG_AUDIO_RING_SIZE / 2)
+        hal_cpu0_wake();
+#endif
+#endif
+
+#ifdef CFG_BENCHMARK
+    bench_add(BENCH_CAPTURE, hal_timer1_read() - t0);
+#endif
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+
+#include "audio.h"
+#include "bench.h"
+#include "hal.h"
+#include "inference.h"
+
+#ifdef CFG_BENCHMARK
+
+// kws_clip[] and KWS_CLIP_SIZE (scripts/gen_audio_clip.py), in MEM0
+#include "kws_clip.h"
+
+#define BENCH_SAMPLES ((uint32_t) KWS_CLIP_SIZE * CFG_BENCH_LOOPS)
+#define BENCH_MAX_RESULTS 32
+
+typedef struct {
+    uint32_t calls;
+    uint32_t cycles;
+    uint32_t max;
+} bench_counter_t;
+
+static const char *const bench_names[BENCH_STAGES] = {
+    "capture", "preproc", "speech", "decode", "sleep"
+};
+
+// Written by the sampling ISR, on the LPCPU with CFG_LPCPU
+static bench_counter_t LPMEM_DATA bench_counters[BENCH_STAGES];
+static volatile uint32_t LPMEM_DATA bench_pos;
+static uint32_t LPMEM_DATA bench_start;
+static volatile uint32_t LPMEM_DATA bench_end;
+
+static uint32_t bench_wakeups;
+static uint32_t bench_results;
+static uint32_t bench_result_pos[BENCH_MAX_RESULTS];
+static int bench_result_label[BENCH_MAX_RESULTS];
+
+void LPMEM_TEXT bench_add(bench_stage_t stage, uint32_t cycles)
+{
+    bench_counter_t *counter = &bench_counters[stage];
+
+    counter->calls++;
+    counter->cycles += cycles;
+    if (cycles > counter->max) counter->max = cycles;
+}
+
+int16_t LPMEM_TEXT bench_sample(void)
+{
+    uint32_t pos = bench_pos;
+
+    if (pos >= BENCH_SAMPLES) return 0;
+    if (pos == 0) bench_start = hal_timer1_read();
+
+    bench_pos = pos + 1;
+    if (pos + 1 == BENCH_SAMPLES) {
+        bench_end = hal_timer1_read();
+#ifdef CFG_LPCPU
+        // CPU0 may be asleep through silence, it prints the report
+        hal_cpu0_wake();
+#endif
+    }
+
+    return kws_clip[pos % KWS_CLIP_SIZE];
+}
+
+void bench_wakeup(void)
+{
+    bench_wakeups++;
+}
+
+void bench_result(int category)
+{
+    if (bench_results < BENCH_MAX_RESULTS) {
+        bench_result_pos[bench_results] = bench_pos;
+        bench_result_label[bench_results] = category;
+    }
+    bench_results++;
+}
+
+int bench_done(void)
+{
+    return bench_pos >= BENCH_SAMPLES;
+}
+
+// Cycle counts are 32-bit TIMER[1] deltas, the clip must play in less than
+// 2^32 cycles
+void bench_report(void)
+{
+    uint32_t elapsed = bench_end - bench_start;
+    uint32_t ms = (uint32_t) ((uint64_t) BENCH_SAMPLES * 1000
+        / CFG_SAMPLE_RATE);
+
+    printf("bench,begin\n");
+    printf("bench,samples,%u\n", (unsigned) BENCH_SAMPLES);
+    printf("bench,duration_ms,%u\n", (unsigned) ms);
+    printf("bench,elapsed_cycles,%u\n", (unsigned) elapsed);
+
+    for (int i = 0; i < BENCH_STAGES; i++) {
+        const bench_counter_t *counter = &bench_counters[i];
+        printf("bench,%s_calls,%u\n", bench_names[i],
+            (unsigned) counter->calls);
+        printf("bench,%s_cycles,%u\n", bench_names[i],
+            (unsigned) counter->cycles);
+        printf("bench,%s_max,%u\n", bench_names[i], (unsigned) counter->max);
+    }
+
+    // Per mille of the run spent sleeping, wake-ups per second of audio
+    printf("bench,sleep_permille,%u\n", elapsed ? (unsigned) ((uint64_t)
+        bench_counters[BENCH_SLEEP].cycles * 1000 / elapsed) : 0);
+    printf("bench,wakeups,%u\n", (unsigned) bench_wakeups);
+    printf("bench,wakeups_per_s,%u\n", ms ? (unsigned) ((uint64_t)
+        bench_wakeups * 1000 / ms) : 0);
+
+    printf("bench,frames,%u\n", (unsigned) audio_frames());
+    printf("bench,idle_frames,%u\n", (unsigned) audio_idle_frames());
+    printf("bench,overruns,%u\n", (unsigned) audio_overruns());
+
+    printf("bench,results,%u\n", (unsigned) bench_results);
+    for (uint32_t i = 0; i < bench_results && i < BENCH_MAX_RESULTS; i++) {
+        printf("bench,result,%u,%s\n", (unsigned) bench_result_pos[i],
+            inference_category_label(bench_result_label[i]));
+    }
+
+    printf("bench,end\n");
+}
+
+#endif
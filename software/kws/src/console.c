@@ -0,0 +1,102 @@
+#include <string.h>
+
+#include "console.h"
+#include "hal.h"
+
+#ifdef CFG_STDOUT_IRQ
+
+#define CONSOLE_MASK (CFG_STDOUT_SIZE - 1)
+
+_Static_assert((CFG_STDOUT_SIZE & CONSOLE_MASK) == 0,
+    "CFG_STDOUT_SIZE must be a power of two");
+
+// Same scheme as audio_ring_t: the writer only moves head, the interrupt
+// only moves tail, both are free-running
+static struct {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+    char data[CFG_STDOUT_SIZE];
+} console;
+
+void console_irq(void)
+{
+    uint32_t head = __atomic_load_n(&console.head, __ATOMIC_ACQUIRE);
+    uint32_t tail = console.tail;
+
+    while (tail != head && hal_uart0_tx_ready())
+        hal_uart0_tx_put(console.data[tail++ & CONSOLE_MASK]);
+
+    __atomic_store_n(&console.tail, tail, __ATOMIC_RELEASE);
+
+    // The interrupt is level triggered, keep it off until there is more
+    if (tail == head)
+        hal_uart0_tx_irq(0);
+}
+
+// Drains what the UART takes right now without the interrupt, the caller
+// may run with interrupts disabled
+static void console_poll(void)
+{
+    uint32_t mstatus = hal_irq_save();
+    console_irq();
+    hal_irq_restore(mstatus);
+}
+
+size_t console_write(const char *buf, size_t len)
+{
+    size_t done = 0;
+
+    while (done < len) {
+        uint32_t head = console.head;
+        uint32_t tail = __atomic_load_n(&console.tail, __ATOMIC_ACQUIRE);
+        size_t room = CFG_STDOUT_SIZE - (head - tail);
+
+        if (room == 0) {
+#ifdef CFG_STDOUT_BLOCK
+            console_poll();
+            continue;
+#else
+            console.dropped += len - done;
+            break;
+#endif
+        }
+
+        size_t n = len - done < room ? len - done : room;
+        size_t at = head & CONSOLE_MASK;
+        size_t first = n < CFG_STDOUT_SIZE - at ? n : CFG_STDOUT_SIZE - at;
+
+        memcpy(&console.data[at], buf + done, first);
+        memcpy(&console.data[0], buf + done + first, n - first);
+        __atomic_store_n(&console.head, head + n, __ATOMIC_RELEASE);
+        done += n;
+
+        // Publish before enabling, the interrupt may fire right away
+        hal_uart0_tx_irq(1);
+    }
+
+    return len;
+}
+
+void console_flush(void)
+{
+    while (__atomic_load_n(&console.tail, __ATOMIC_ACQUIRE) != console.head)
+        console_poll();
+
+    while (!hal_uart0_tx_ready());
+}
+
+uint32_t console_dropped(void)
+{
+    return console.dropped;
+}
+
+#ifdef CFG_LPCPU
+// The sampling interrupts go to the LPCPU, CPU0 only takes the UART one
+void __attribute__((interrupt)) default_handler(void)
+{
+    console_irq();
+}
+#endif
+
+#endif
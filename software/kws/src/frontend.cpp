@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "signal/src/complex.h"
+#include "signal/src/log.h"
+#include "signal/src/msb.h"
+#include "signal/src/pcan_argc_fixed.h"
+#include "signal/src/rfft.h"
+#include "signal/src/square_root.h"
+
+#include "cfg.h"
+#include "frontend.h"
+
+#ifdef CFG_NATIVE_FRONTEND
+
+// FRONTEND_* parameters and tables of the preprocessor model
+// (scripts/gen_frontend.py)
+#include "kws_frontend.h"
+
+static_assert(FRONTEND_FRAME_SIZE == CFG_AUDIO_DURATION_COUNT,
+              "preprocessor frame does not match the capture");
+static_assert(FRONTEND_CHANNELS == CFG_FEATURE_SIZE,
+              "preprocessor channels do not match the features");
+
+namespace {
+
+constexpr int kBins = FRONTEND_FFT_LENGTH / 2 + 1;
+
+// kissfft state for the int16 RFFT of the signal library, the same
+// transform as the SignalRfft op
+constexpr size_t kFftStateSize = 4096;
+
+alignas(8) uint8_t g_fft_state[kFftStateSize];
+void* g_fft = nullptr;
+
+// Windowed frame, zero-padded to the FFT length
+int16_t g_fft_input[FRONTEND_FFT_LENGTH];
+tflm_signal::Complex<int16_t> g_spectrum[kBins];
+
+// Bins outside [FRONTEND_ENERGY_START, FRONTEND_ENERGY_END) stay zero, the
+// model zeroes them between the energy and the filter bank
+uint32_t g_energy[kBins];
+
+// Spectral subtraction state, one noise estimate per channel
+uint32_t g_noise[FRONTEND_CHANNELS];
+
+// Window and auto scale (SignalWindow, SignalFftAutoScale). The maximum is
+// kept in int16 like MaxAbs16, -32768 included. Returns the scale bits.
+HOT_TEXT int WindowFrame(const int16_t* in) {
+  int16_t max = 0;
+  for (int i = 0; i < FRONTEND_FRAME_SIZE; i++) {
+    const int16_t value = static_cast<int16_t>(
+        (static_cast<int32_t>(in[i]) * frontend_window[i]) >>
+        FRONTEND_WINDOW_SHIFT);
+    g_fft_input[i] = value;
+    if (value > max) {
+      max = value;
+    } else if (-value > max) {
+      max = -value;
+    }
+  }
+
+  int scale_bits = 16 - tflm_signal::MostSignificantBit32(max) - 1;
+  if (scale_bits <= 0) return 0;
+
+  for (int i = 0; i < FRONTEND_FRAME_SIZE; i++) {
+    g_fft_input[i] = g_fft_input[i] * (1 << scale_bits);
+  }
+  return scale_bits;
+}
+
+// SignalEnergy over the kept bins
+HOT_TEXT void Energy(void) {
+  for (int i = FRONTEND_ENERGY_START; i < FRONTEND_ENERGY_END; i++) {
+    const int32_t re = g_spectrum[i].real;
+    const int32_t im = g_spectrum[i].imag;
+    g_energy[i] = static_cast<uint32_t>(re * re) +
+                  static_cast<uint32_t>(im * im);
+  }
+}
+
+// Spectral subtraction, PCAN, log and int8 quantization of one channel
+HOT_TEXT int8_t Channel(int channel, uint64_t energy, int scale_bits) {
+  // SignalFilterBankSquareRoot
+  const uint32_t input = tflm_signal::Sqrt64(energy) >> scale_bits;
+
+  // SignalFilterBankSpectralSubtraction, the odd channels use the alternate
+  // smoothing
+  uint32_t smoothing = FRONTEND_NR_SMOOTHING;
+  uint32_t one_minus_smoothing = FRONTEND_NR_ONE_MINUS_SMOOTHING;
+  if (channel & 1) {
+    smoothing = FRONTEND_NR_ALT_SMOOTHING;
+    one_minus_smoothing = FRONTEND_NR_ALT_ONE_MINUS_SMOOTHING;
+  }
+
+  const uint32_t scaled_up = input << FRONTEND_NR_SMOOTHING_BITS;
+  uint32_t& noise = g_noise[channel];
+  noise = (static_cast<uint64_t>(scaled_up) * smoothing +
+           static_cast<uint64_t>(noise) * one_minus_smoothing) >>
+          FRONTEND_NR_BITS;
+
+  uint32_t estimate = noise;
+  if (estimate > scaled_up) {
+    estimate = scaled_up;
+    if (FRONTEND_NR_CLAMPING) noise = estimate;
+  }
+  const uint32_t floor =
+      (static_cast<uint64_t>(input) * FRONTEND_NR_MIN_SIGNAL_REMAINING) >>
+      FRONTEND_NR_BITS;
+  const uint32_t subtracted =
+      (scaled_up - estimate) >> FRONTEND_NR_SMOOTHING_BITS;
+  const uint32_t signal = std::max(subtracted, floor);
+
+  // SignalPCAN
+  const uint32_t gain = static_cast<uint32_t>(
+      tflm_signal::WideDynamicFunction(noise, frontend_pcan_lut));
+  const uint32_t snr = (static_cast<uint64_t>(signal) * gain) >>
+                       FRONTEND_PCAN_SNR_SHIFT;
+  const uint32_t pcan = tflm_signal::PcanShrink(snr);
+
+  // SignalFilterBankLog
+  const uint32_t scaled = pcan << FRONTEND_LOG_CORRECTION_BITS;
+  uint32_t log = 0;
+  if (scaled > 1) {
+    log = std::min<uint32_t>(tflm_signal::Log32(scaled, FRONTEND_LOG_SCALE),
+                             INT16_MAX);
+  }
+
+  // (log * MUL + ADD) / DIV + ZP clamped to int8, the division is exact for
+  // the whole int16 range as a multiply and a shift
+  const uint32_t n = log * FRONTEND_QUANT_MUL + FRONTEND_QUANT_ADD;
+  const int32_t q = static_cast<int32_t>(
+      (static_cast<uint64_t>(n) * FRONTEND_QUANT_DIV_MUL) >>
+      FRONTEND_QUANT_DIV_SHIFT) + FRONTEND_QUANT_ZERO_POINT;
+  return static_cast<int8_t>(
+      std::max<int32_t>(std::min<int32_t>(q, FRONTEND_QUANT_MAX),
+                        FRONTEND_QUANT_MIN));
+}
+
+}  // namespace
+
+extern "C" int frontend_init(void) {
+  if (g_fft) return 0;
+  if (tflm_signal::RfftInt16GetNeededMemory(FRONTEND_FFT_LENGTH) >
+      kFftStateSize) {
+    return -1;
+  }
+  g_fft = tflm_signal::RfftInt16Init(FRONTEND_FFT_LENGTH, g_fft_state,
+                                     kFftStateSize);
+  frontend_reset();
+  return g_fft ? 0 : -1;
+}
+
+extern "C" void frontend_reset(void) {
+  std::fill_n(g_noise, FRONTEND_CHANNELS, 0);
+}
+
+// The filter bank accumulates the weighted energy of a channel and the
+// unweighted one of the next, as FilterbankAccumulateChannels does. Each
+// channel is finished as soon as its sum is complete, the first sum only
+// carries over to channel 0 and is dropped.
+extern "C" HOT_TEXT void frontend_run(const int16_t* audio_frame,
+                                      int8_t* features) {
+  const int scale_bits = WindowFrame(audio_frame);
+  tflm_signal::RfftInt16Apply(g_fft, g_fft_input, g_spectrum);
+  Energy();
+
+  uint64_t weighted = 0;
+  uint64_t unweighted = 0;
+  for (int i = 0; i <= FRONTEND_CHANNELS; i++) {
+    const uint32_t* energy = &g_energy[frontend_channel_starts[i]];
+    const int16_t* weights =
+        &frontend_weights[frontend_channel_weight_starts[i]];
+    const int16_t* unweights =
+        &frontend_unweights[frontend_channel_weight_starts[i]];
+    for (int j = 0; j < frontend_channel_widths[i]; j++) {
+      weighted += weights[j] * static_cast<uint64_t>(energy[j]);
+      unweighted += unweights[j] * static_cast<uint64_t>(energy[j]);
+    }
+    if (i > 0) features[i - 1] = Channel(i - 1, weighted, scale_bits);
+    weighted = unweighted;
+    unweighted = 0;
+  }
+}
+
+#endif
@@ -0,0 +1,549 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/micro/kernels/conv.h"
+#include "tensorflow/lite/micro/kernels/depthwise_conv.h"
+#include "tensorflow/lite/micro/kernels/fully_connected.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+#include "gmsv.h"
+#include "gmsv_kernels.h"
+
+namespace {
+
+constexpr int kDim = GMSV_DIM;
+constexpr int kTileBytes = kDim * kDim;
+
+// Scratchpad layout, in rows. A and B are double buffered so the next tiles
+// move in while the array works on the current ones.
+constexpr uint32_t kSpadA[2] = {0x00, 0x08};
+constexpr uint32_t kSpadB[2] = {0x10, 0x18};
+constexpr uint32_t kSpadZero = 0x20;
+constexpr uint32_t kSpadAcc = 0x28;
+
+// mvin/mvout configurations: A rows use the operand stride, B tiles are
+// packed and the accumulator tile moves out as int32 rows
+#define CFG_A 0
+#define CFG_B 1
+#define CFG_ACC 2
+
+const int8_t kZeroTile[kTileBytes] __attribute__((aligned(4))) = {};
+
+// The reference registrations, used for Init/Prepare and as fallback
+TFLMRegistration g_fc_reference;
+TFLMRegistration g_conv_reference;
+TFLMRegistration g_dw_reference;
+
+enum class SelfTest { kPending, kPassed, kFailed };
+SelfTest g_self_test = SelfTest::kPending;
+
+void Setup(uint32_t a_stride) {
+  CSR_WRITE(GMSV_CSR_CTRL, 0);
+  CSR_WRITE(GMSV_CSR_STRIDE(CFG_A), a_stride);
+  CSR_WRITE(GMSV_CSR_STRIDE(CFG_B), kDim);
+  CSR_WRITE(GMSV_CSR_STRIDE(CFG_ACC), kDim * sizeof(int32_t));
+  MVIN(kZeroTile, kSpadZero, CFG_B);
+}
+
+// acc = A * B over k_tiles tiles. A is kDim rows of the operand in main
+// memory, B the matching kDim x kDim tiles packed back to back. While the
+// array multiplies tile t, tile t + 1 moves into the other buffer.
+void Matmul(const int8_t* a, const int8_t* b, int k_tiles,
+            int32_t acc[kDim][kDim]) {
+  MVIN(a, kSpadA[0], CFG_A);
+  MVIN(b, kSpadB[0], CFG_B);
+
+  for (int t = 0; t < k_tiles; t++) {
+    const int slot = t & 1;
+
+    if (t + 1 < k_tiles) {
+      MVIN(a + (t + 1) * kDim, kSpadA[slot ^ 1], CFG_A);
+      MVIN(b + (t + 1) * kTileBytes, kSpadB[slot ^ 1], CFG_B);
+    }
+
+    MATMUL(kSpadA[slot], kSpadB[slot], t == 0 ? kSpadZero : kSpadAcc,
+           kSpadAcc, 0);
+  }
+
+  MVOUT(acc, kSpadAcc, CFG_ACC);
+  FENCE(0);
+}
+
+// Multiply two tiles that overflow 8 and 16 bits against the CPU result.
+// Gemmini-SV builds without signed int8 operands or int32 accumulators would
+// give wrong answers, the kernels then stay on the reference path.
+bool RunSelfTest() {
+  // A is kDim rows of two tiles, B the two matching tiles
+  int8_t a[kDim][2 * kDim] __attribute__((aligned(4)));
+  int8_t b[2 * kTileBytes] __attribute__((aligned(4)));
+  int32_t acc[kDim][kDim];
+
+  for (int i = 0; i < 2 * kTileBytes; i++) {
+    a[i / (2 * kDim)][i % (2 * kDim)] =
+        static_cast<int8_t>(i & 1 ? -128 : 127 - i);
+    b[i] = static_cast<int8_t>(i & 2 ? 127 : -127 + 3 * i);
+  }
+
+  Setup(2 * kDim);
+  Matmul(&a[0][0], b, 2, acc);
+
+  for (int r = 0; r < kDim; r++) {
+    for (int c = 0; c < kDim; c++) {
+      int32_t expected = 0;
+      for (int k = 0; k < 2 * kDim; k++) {
+        const int8_t* tile = b + (k / kDim) * kTileBytes;
+        expected += a[r][k] * tile[(k % kDim) * kDim + c];
+      }
+      if (acc[r][c] != expected) return false;
+    }
+  }
+  return true;
+}
+
+bool Available() {
+  if (g_self_test == SelfTest::kPending) {
+    g_self_test = RunSelfTest() ? SelfTest::kPassed : SelfTest::kFailed;
+    if (g_self_test == SelfTest::kFailed) {
+      printf("gmsv: self-test failed, using reference kernels\n");
+    }
+  }
+  return g_self_test == SelfTest::kPassed;
+}
+
+inline int RoundUp(int value) { return (value + kDim - 1) / kDim * kDim; }
+
+inline int8_t Requantize(int32_t acc, int32_t multiplier, int shift,
+                         int32_t offset, int32_t act_min, int32_t act_max) {
+  acc = tflite::MultiplyByQuantizedMultiplier(acc, multiplier, shift);
+  acc += offset;
+  if (acc < act_min) acc = act_min;
+  if (acc > act_max) acc = act_max;
+  return static_cast<int8_t>(acc);
+}
+
+bool IsPerTensor(const TfLiteTensor* tensor) {
+  if (tensor->quantization.type != kTfLiteAffineQuantization) return false;
+  const auto* quant = static_cast<const TfLiteAffineQuantization*>(
+      tensor->quantization.params);
+  return quant->scale->size == 1;
+}
+
+// FullyConnected =============================================================
+//
+// out^T = W * x^T: the filter rows are the A operand, read in place, and the
+// inputs of up to kDim batches are packed as B tiles.
+
+struct OpDataFullyConnectedGmsv {
+  tflite::OpDataFullyConnected reference;
+  bool offload;
+  int32_t* row_offsets;
+  int input_buffer;
+};
+
+void* FullyConnectedInitGmsv(TfLiteContext* context, const char* buffer,
+                             size_t length) {
+  return context->AllocatePersistentBuffer(context,
+                                           sizeof(OpDataFullyConnectedGmsv));
+}
+
+TfLiteStatus FullyConnectedPrepareGmsv(TfLiteContext* context,
+                                       TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(g_fc_reference.prepare(context, node));
+
+  auto* data = static_cast<OpDataFullyConnectedGmsv*>(node->user_data);
+  tflite::MicroContext* micro_context = tflite::GetMicroContext(context);
+
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(
+      node, tflite::kFullyConnectedInputTensor);
+  TfLiteTensor* filter = micro_context->AllocateTempInputTensor(
+      node, tflite::kFullyConnectedWeightsTensor);
+  TfLiteTensor* bias = micro_context->AllocateTempInputTensor(
+      node, tflite::kFullyConnectedBiasTensor);
+  TfLiteTensor* output = micro_context->AllocateTempOutputTensor(
+      node, tflite::kFullyConnectedOutputTensor);
+
+  const int depth = filter->dims->data[filter->dims->size - 1];
+  const int rows = filter->dims->data[0];
+
+  data->offload = input->type == kTfLiteInt8 &&
+                  filter->type == kTfLiteInt8 &&
+                  output->type == kTfLiteInt8 &&
+                  (bias == nullptr || bias->type == kTfLiteInt32) &&
+                  IsPerTensor(filter) &&
+                  depth % kDim == 0 && rows % kDim == 0 &&
+                  Available();
+
+  if (data->offload) {
+    const int32_t input_offset = -data->reference.input_zero_point;
+    const int32_t filter_offset = -data->reference.filter_zero_point;
+    const int8_t* filter_data = tflite::GetTensorData<int8_t>(filter);
+    const int32_t* bias_data =
+        bias ? tflite::GetTensorData<int32_t>(bias) : nullptr;
+
+    data->row_offsets = static_cast<int32_t*>(
+        context->AllocatePersistentBuffer(context, rows * sizeof(int32_t)));
+    if (data->row_offsets == nullptr) return kTfLiteError;
+
+    for (int r = 0; r < rows; r++) {
+      int32_t sum = 0;
+      for (int d = 0; d < depth; d++) sum += filter_data[r * depth + d];
+      data->row_offsets[r] = (bias_data ? bias_data[r] : 0) +
+                             input_offset * sum +
+                             depth * filter_offset * input_offset;
+    }
+
+    TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+        context, depth * kDim, &data->input_buffer));
+  }
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(filter);
+  if (bias) micro_context->DeallocateTempTfLiteTensor(bias);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+TfLiteStatus FullyConnectedEvalGmsv(TfLiteContext* context, TfLiteNode* node) {
+  const auto* data = static_cast<const OpDataFullyConnectedGmsv*>(
+      node->user_data);
+  if (!data->offload) return g_fc_reference.invoke(context, node);
+
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(
+      context, node, tflite::kFullyConnectedInputTensor);
+  const TfLiteEvalTensor* filter = tflite::micro::GetEvalInput(
+      context, node, tflite::kFullyConnectedWeightsTensor);
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(
+      context, node, tflite::kFullyConnectedOutputTensor);
+
+  const tflite::RuntimeShape output_shape =
+      tflite::micro::GetTensorShape(output);
+  const tflite::RuntimeShape filter_shape =
+      tflite::micro::GetTensorShape(filter);
+  const int output_dims = output_shape.DimensionsCount();
+  const int batches = tflite::FlatSizeSkipDim(output_shape, output_dims - 1);
+  const int rows = output_shape.Dims(output_dims - 1);
+  const int depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  const int k_tiles = depth / kDim;
+
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  int8_t* packed = static_cast<int8_t*>(
+      context->GetScratchBuffer(context, data->input_buffer));
+
+  const tflite::OpDataFullyConnected& ref = data->reference;
+  const int32_t filter_offset = -ref.filter_zero_point;
+  int32_t acc[kDim][kDim];
+
+  Setup(depth);
+
+  for (int b0 = 0; b0 < batches; b0 += kDim) {
+    const int count = batches - b0 < kDim ? batches - b0 : kDim;
+    int32_t input_terms[kDim] = {};
+
+    // B tile t holds x[b0 + c][t * kDim + k] at row k, column c
+    memset(packed, 0, depth * kDim);
+    for (int c = 0; c < count; c++) {
+      const int8_t* x = input_data + (b0 + c) * depth;
+      for (int d = 0; d < depth; d++) {
+        packed[(d / kDim) * kTileBytes + (d % kDim) * kDim + c] = x[d];
+        input_terms[c] += x[d];
+      }
+      input_terms[c] *= filter_offset;
+    }
+
+    for (int r0 = 0; r0 < rows; r0 += kDim) {
+      Matmul(filter_data + r0 * depth, packed, k_tiles, acc);
+
+      for (int r = 0; r < kDim; r++) {
+        for (int c = 0; c < count; c++) {
+          output_data[(b0 + c) * rows + r0 + r] = Requantize(
+              acc[r][c] + data->row_offsets[r0 + r] + input_terms[c],
+              ref.output_multiplier, ref.output_shift, ref.output_zero_point,
+              ref.output_activation_min, ref.output_activation_max);
+        }
+      }
+    }
+  }
+
+  return kTfLiteOk;
+}
+
+// Conv2D and DepthwiseConv2D =================================================
+//
+// out = patches * F: kDim output pixels are unrolled (im2col) into the A
+// operand, the filter is packed as B tiles once in Prepare. A depthwise
+// convolution of a single-channel input is a plain convolution with
+// depth_multiplier output channels. Padding pixels take the input zero
+// point, so they drop out like in the reference kernels.
+
+struct OpDataConvGmsv {
+  tflite::OpDataConv reference;
+  bool offload;
+  int8_t* filter_tiles;
+  int32_t* bias;
+  int k_tiles;
+  int patch_buffer;
+};
+
+struct ConvGeometry {
+  int stride_width;
+  int stride_height;
+  int dilation_width;
+  int dilation_height;
+};
+
+void* ConvInitGmsv(TfLiteContext* context, const char* buffer,
+                   size_t length) {
+  return context->AllocatePersistentBuffer(context, sizeof(OpDataConvGmsv));
+}
+
+TfLiteStatus ConvPrepareGmsv(TfLiteContext* context, TfLiteNode* node,
+                             bool depthwise) {
+  auto* data = static_cast<OpDataConvGmsv*>(node->user_data);
+  tflite::MicroContext* micro_context = tflite::GetMicroContext(context);
+
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(
+      node, tflite::kConvInputTensor);
+  TfLiteTensor* filter = micro_context->AllocateTempInputTensor(
+      node, tflite::kConvWeightsTensor);
+  TfLiteTensor* bias = micro_context->AllocateTempInputTensor(
+      node, tflite::kConvBiasTensor);
+  TfLiteTensor* output = micro_context->AllocateTempOutputTensor(
+      node, tflite::kConvOutputTensor);
+
+  // Conv2D filters are [channels, height, width, input depth], depthwise
+  // ones [1, height, width, channels]. filter(k, c) is at
+  // k * k_step + c * c_step, k running over (fy, fx, input channel).
+  const int k_size = filter->dims->data[1] * filter->dims->data[2] *
+                     input->dims->data[3];
+  const int channels = output->dims->data[3];
+  const int k_step = depthwise ? channels : 1;
+  const int c_step = depthwise ? 1 : k_size;
+
+  data->offload = (!depthwise || input->dims->data[3] == 1) &&
+                  input->type == kTfLiteInt8 &&
+                  filter->type == kTfLiteInt8 &&
+                  output->type == kTfLiteInt8 &&
+                  (bias == nullptr || bias->type == kTfLiteInt32) &&
+                  Available();
+
+  if (data->offload) {
+    const int k_padded = RoundUp(k_size);
+    const int c_padded = RoundUp(channels);
+    const int32_t input_offset = -input->params.zero_point;
+    const int8_t* filter_data = tflite::GetTensorData<int8_t>(filter);
+    const int32_t* bias_data =
+        bias ? tflite::GetTensorData<int32_t>(bias) : nullptr;
+
+    data->k_tiles = k_padded / kDim;
+    data->filter_tiles = static_cast<int8_t*>(
+        context->AllocatePersistentBuffer(context, k_padded * c_padded));
+    data->bias = static_cast<int32_t*>(context->AllocatePersistentBuffer(
+        context, channels * sizeof(int32_t)));
+    if (data->filter_tiles == nullptr || data->bias == nullptr) {
+      return kTfLiteError;
+    }
+
+    // Tile (n, t) holds filter(t * kDim + k, n * kDim + c) at row k, col c
+    memset(data->filter_tiles, 0, k_padded * c_padded);
+    for (int c = 0; c < channels; c++) {
+      int32_t sum = 0;
+      for (int k = 0; k < k_size; k++) {
+        const int8_t f = filter_data[k * k_step + c * c_step];
+        const int tile = (c / kDim) * data->k_tiles + k / kDim;
+        data->filter_tiles[tile * kTileBytes + (k % kDim) * kDim + c % kDim] =
+            f;
+        sum += f;
+      }
+      data->bias[c] = (bias_data ? bias_data[c] : 0) + input_offset * sum;
+    }
+
+    TF_LITE_ENSURE_STATUS(context->RequestScratchBufferInArena(
+        context, kDim * k_padded, &data->patch_buffer));
+  }
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(filter);
+  if (bias) micro_context->DeallocateTempTfLiteTensor(bias);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+TfLiteStatus ConvEvalGmsv(TfLiteContext* context, TfLiteNode* node,
+                          const ConvGeometry& geometry,
+                          const tflite::PaddingValues& padding,
+                          int32_t output_offset, int32_t act_min,
+                          int32_t act_max) {
+  const auto* data = static_cast<const OpDataConvGmsv*>(node->user_data);
+
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(
+      context, node, tflite::kConvInputTensor);
+  const TfLiteEvalTensor* filter = tflite::micro::GetEvalInput(
+      context, node, tflite::kConvWeightsTensor);
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(
+      context, node, tflite::kConvOutputTensor);
+
+  const tflite::RuntimeShape input_shape =
+      tflite::micro::GetTensorShape(input);
+  const tflite::RuntimeShape filter_shape =
+      tflite::micro::GetTensorShape(filter);
+  const tflite::RuntimeShape output_shape =
+      tflite::micro::GetTensorShape(output);
+
+  const int batches = input_shape.Dims(0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int channels = output_shape.Dims(3);
+  const int pixels = output_height * output_width;
+  const int k_padded = data->k_tiles * kDim;
+
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+  int8_t* patches = static_cast<int8_t*>(
+      context->GetScratchBuffer(context, data->patch_buffer));
+  const int8_t pad = static_cast<int8_t>(data->reference.input_zero_point);
+
+  const int32_t* multiplier = data->reference.per_channel_output_multiplier;
+  const int32_t* shift = data->reference.per_channel_output_shift;
+  int32_t acc[kDim][kDim];
+
+  Setup(k_padded);
+
+  for (int b = 0; b < batches; b++) {
+    const int8_t* image =
+        input_data + b * input_height * input_width * input_depth;
+    int8_t* out = output_data + b * pixels * channels;
+
+    for (int p0 = 0; p0 < pixels; p0 += kDim) {
+      const int count = pixels - p0 < kDim ? pixels - p0 : kDim;
+
+      // im2col, the padding columns of K multiply zero filter rows
+      memset(patches, pad, kDim * k_padded);
+      for (int p = 0; p < count; p++) {
+        const int out_y = (p0 + p) / output_width;
+        const int out_x = (p0 + p) % output_width;
+        const int y0 = out_y * geometry.stride_height - padding.height;
+        const int x0 = out_x * geometry.stride_width - padding.width;
+        int8_t* patch = patches + p * k_padded;
+
+        for (int fy = 0; fy < filter_height; fy++) {
+          const int y = y0 + fy * geometry.dilation_height;
+          if (y < 0 || y >= input_height) continue;
+          for (int fx = 0; fx < filter_width; fx++) {
+            const int x = x0 + fx * geometry.dilation_width;
+            if (x < 0 || x >= input_width) continue;
+            memcpy(patch + (fy * filter_width + fx) * input_depth,
+                   image + (y * input_width + x) * input_depth, input_depth);
+          }
+        }
+      }
+
+      for (int c0 = 0; c0 < channels; c0 += kDim) {
+        Matmul(patches,
+               data->filter_tiles + (c0 / kDim) * data->k_tiles * kTileBytes,
+               data->k_tiles, acc);
+
+        for (int p = 0; p < count; p++) {
+          for (int c = c0; c < channels && c < c0 + kDim; c++) {
+            out[(p0 + p) * channels + c] = Requantize(
+                acc[p][c - c0] + data->bias[c], multiplier[c], shift[c],
+                output_offset, act_min, act_max);
+          }
+        }
+      }
+    }
+  }
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus Conv2DPrepareGmsv(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(g_conv_reference.prepare(context, node));
+  return ConvPrepareGmsv(context, node, false);
+}
+
+TfLiteStatus Conv2DEvalGmsv(TfLiteContext* context, TfLiteNode* node) {
+  const auto* data = static_cast<const OpDataConvGmsv*>(node->user_data);
+  if (!data->offload) return g_conv_reference.invoke(context, node);
+
+  const auto& params =
+      *static_cast<const TfLiteConvParams*>(node->builtin_data);
+  const tflite::ConvParams op_params =
+      tflite::ConvParamsQuantized(params, data->reference);
+  const ConvGeometry geometry = {
+      params.stride_width, params.stride_height,
+      params.dilation_width_factor, params.dilation_height_factor};
+
+  return ConvEvalGmsv(context, node, geometry, op_params.padding_values,
+                      op_params.output_offset,
+                      op_params.quantized_activation_min,
+                      op_params.quantized_activation_max);
+}
+
+TfLiteStatus DepthwiseConvPrepareGmsv(TfLiteContext* context,
+                                      TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(g_dw_reference.prepare(context, node));
+  return ConvPrepareGmsv(context, node, true);
+}
+
+TfLiteStatus DepthwiseConvEvalGmsv(TfLiteContext* context, TfLiteNode* node) {
+  const auto* data = static_cast<const OpDataConvGmsv*>(node->user_data);
+  if (!data->offload) return g_dw_reference.invoke(context, node);
+
+  const auto& params =
+      *static_cast<const TfLiteDepthwiseConvParams*>(node->builtin_data);
+  const tflite::DepthwiseParams op_params =
+      tflite::DepthwiseConvParamsQuantized(params, data->reference);
+  const ConvGeometry geometry = {
+      params.stride_width, params.stride_height,
+      params.dilation_width_factor, params.dilation_height_factor};
+
+  return ConvEvalGmsv(context, node, geometry, op_params.padding_values,
+                      op_params.output_offset,
+                      op_params.quantized_activation_min,
+                      op_params.quantized_activation_max);
+}
+
+}  // namespace
+
+TFLMRegistration Register_FULLY_CONNECTED_GMSV() {
+  g_fc_reference = tflite::Register_FULLY_CONNECTED();
+
+  TFLMRegistration registration = g_fc_reference;
+  registration.init = FullyConnectedInitGmsv;
+  registration.prepare = FullyConnectedPrepareGmsv;
+  registration.invoke = FullyConnectedEvalGmsv;
+  return registration;
+}
+
+TFLMRegistration Register_CONV_2D_GMSV() {
+  g_conv_reference = tflite::Register_CONV_2D();
+
+  TFLMRegistration registration = g_conv_reference;
+  registration.init = ConvInitGmsv;
+  registration.prepare = Conv2DPrepareGmsv;
+  registration.invoke = Conv2DEvalGmsv;
+  return registration;
+}
+
+TFLMRegistration Register_DEPTHWISE_CONV_2D_GMSV() {
+  g_dw_reference = tflite::Register_DEPTHWISE_CONV_2D();
+
+  TFLMRegistration registration = g_dw_reference;
+  registration.init = ConvInitGmsv;
+  registration.prepare = DepthwiseConvPrepareGmsv;
+  registration.invoke = DepthwiseConvEvalGmsv;
+  return registration;
+}
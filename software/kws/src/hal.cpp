@@ -0,0 +1,52 @@
+#include "adam_ral.hpp"
+
+extern "C" {
+#include "hal.h"
+}
+
+// Init sequences over the register descriptors of adam_ral.hpp. Each
+// ral::modify() is one load and one store of the register, where a bitfield
+// of the C RAL costs a read-modify-write per field. The frame format is
+// still set before the enables.
+
+namespace {
+
+using Uart0 = ral::LSPA::UART<0>;
+using Spi0 = ral::LSPA::SPI<0>;
+
+}  // namespace
+
+extern "C" void hal_uart0_init(void) {
+  RAL.SYSCFG->LSPA.UART[0].MR = 1;
+  while (RAL.SYSCFG->LSPA.UART[0].MR);
+
+  Uart0::BRR::write(SYSTEM_CLOCK / 115200);
+
+  ral::modify<Uart0::CR::TE, Uart0::CR::RE, Uart0::CR::DL>(1, 1, 8);
+  ral::modify<Uart0::CR::PE>(1);
+}
+
+extern "C" void hal_spi0_init(void) {
+  RAL.SYSCFG->LSPA.SPI[0].MR = 1;
+  while (RAL.SYSCFG->LSPA.SPI[0].MR);
+
+  ral::modify<Spi0::CR::MS, Spi0::CR::CPHA, Spi0::CR::CPOL, Spi0::CR::DO,
+              Spi0::CR::DL>(1, 0, 0, 1, 15);
+
+  Spi0::BRR::write(SYSTEM_CLOCK / 1000000);
+
+  ral::modify<Spi0::CR::PE, Spi0::CR::TE, Spi0::CR::RE>(1, 1, 1);
+
+#ifdef CFG_SPI_FIFO
+  // Every TIMER[0] reload resends the word in DR, the interrupt fires once
+  // a burst of samples is in the RX FIFO. Writing DR also starts a transfer
+  // at once, so the word is loaded with the trigger off and its untimed
+  // reply dropped before the trigger and the watermark are enabled.
+  Spi0::DR::write(0xFF);
+  while (!ral::read<Spi0::SR::RBF>());
+  Spi0::DR::read();
+
+  ral::modify<Spi0::FCR::RXWM, Spi0::FCR::TTE>(CFG_AUDIO_BURST, 1);
+  ral::modify<Spi0::IER::RWMIE>(1);
+#endif
+}
@@ -2,168 +2,579 @@
 #include <cstdint>
 #include <iterator>
 #include <cstdio>
+#include <new>
 
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/micro/micro_interpreter.h"
 #include "tensorflow/lite/micro/micro_log.h"
-#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
 
+#include "cfg.h"
+
+// Placed in MEM1 with CFG_BANK_PLACEMENT, away from the code fetches. The
+// preprocessor model is left out with CFG_NATIVE_FRONTEND.
+#ifndef CFG_NATIVE_FRONTEND
+extern const unsigned char MODEL_DATA __audio_preprocessor_int8_tflite[];
+#endif
+extern const unsigned char MODEL_DATA __micro_speech_quantized_tflite[];
+
+#ifndef CFG_NATIVE_FRONTEND
 #include "audio_preprocessor_int8_tflite.h"
+#endif
 #include "micro_speech_quantized_tflite.h"
 
+#include "bench.h"
+#include "frontend.h"
+#include "gmsv_kernels.h"
 #include "inference.h"
+#include "opt_kernels.h"
+#include "profiler.h"
+
+#ifdef CFG_BENCHMARK
+extern "C" {
+#include "hal.h"
+}
+#endif
 
-// Number of categories and labels
-constexpr int kCategoryCount = 4;
-constexpr const char* kCategoryLabels[kCategoryCount] = {
+// Kernel overrides for the generated op resolvers
+#if defined(CFG_GEMMINI)
+#define OP_RESOLVER_FULLY_CONNECTED Register_FULLY_CONNECTED_GMSV()
+#define OP_RESOLVER_DEPTHWISE_CONV_2D Register_DEPTHWISE_CONV_2D_GMSV()
+#define OP_RESOLVER_CONV_2D Register_CONV_2D_GMSV()
+#elif defined(CFG_OPT_KERNELS)
+#define OP_RESOLVER_FULLY_CONNECTED Register_FULLY_CONNECTED_OPT()
+#define OP_RESOLVER_DEPTHWISE_CONV_2D Register_DEPTHWISE_CONV_2D_OPT()
+#endif
+
+// PreprocessorOpResolver, SpeechOpResolver and their Register*Ops(), sized
+// to the operators of the models (scripts/gen_op_resolver.py)
+#include "kws_ops.h"
+
+// Categories of micro_speech
+constexpr const char* kMicroSpeechLabels[] = {
   "silence",
   "unknown",
   "yes",
   "no",
 };
 
-// Separate arenas for each interpreter
-constexpr size_t kPreprocArenaSize = 28584;
-constexpr size_t kSpeechArenaSize = 28584;
-alignas(16) static uint8_t g_preproc_arena[kPreprocArenaSize];
-alignas(16) static uint8_t g_speech_arena[kSpeechArenaSize];
+// Each interpreter keeps its own persistent region (allocator, tensor
+// metadata, operator state) while the non-persistent region holding
+// activations and scratch buffers is shared, the two models never run
+// concurrently. The native frontend needs neither.
+#ifndef CFG_NATIVE_FRONTEND
+constexpr size_t kPreprocPersistentSize = CFG_ARENA_PREPROC_PERSISTENT;
+#endif
+constexpr size_t kSpeechPersistentSize = CFG_ARENA_SPEECH_PERSISTENT;
+constexpr size_t kScratchArenaSize = CFG_ARENA_SCRATCH;
+
+// With CFG_MEM_GATING the scratch region lives in MEM2, which is powered down
+// during silence. The interpreters and their persistent regions stay in MEM1
+// and resume warm, or with CFG_MEM_GATING_COLD they go to MEM2 as well and
+// are rebuilt on the first use after a wake-up.
+#ifdef CFG_MEM_GATING_COLD
+#define INFERENCE_STATE MEM2_BSS
+#else
+#define INFERENCE_STATE
+#endif
+
+#ifndef CFG_NATIVE_FRONTEND
+alignas(16) static uint8_t INFERENCE_STATE
+    g_preproc_persistent[kPreprocPersistentSize];
+#endif
+alignas(16) static uint8_t INFERENCE_STATE
+    g_micro_speech_persistent[kSpeechPersistentSize];
+alignas(16) static uint8_t MEM2_BSS g_scratch_arena[kScratchArenaSize];
 
+// Rolling window of feature frames, g_feature_head is the oldest frame and
+// the slot overwritten by the next preprocessor step
 using Features = int8_t[CFG_FEATURE_COUNT][CFG_FEATURE_SIZE];
 static Features g_features;
+static int g_feature_head = 0;
+static int g_feature_fill = 0;
 
-using PreprocessorOpResolver = tflite::MicroMutableOpResolver<18>;
-using SpeechOpResolver = tflite::MicroMutableOpResolver<4>;
-
+#ifndef CFG_NATIVE_FRONTEND
 static PreprocessorOpResolver g_preproc_op_resolver;
+#endif
 static SpeechOpResolver g_speech_op_resolver;
 
+// Speech model registry. Every model takes the feature window as input and
+// lists its categories with "silence" and "unknown" first. Each one keeps its
+// own interpreter and persistent region, so switching models costs nothing
+// once they are built and the features are never recomputed. A model is
+// added here with a NAME=MODEL entry for gen_op_resolver.py in CMakeLists.txt
+// and its resolver below.
+struct SpeechModel {
+  const char* name;
+  const unsigned char* data;
+  const char* const* labels;
+  int category_count;
+  tflite::MicroOpResolver* resolver;
+  TfLiteStatus (*register_ops)(void);
+  uint8_t* persistent;
+  size_t persistent_size;
+};
+
+constexpr SpeechModel kSpeechModels[] = {
+  {"micro_speech", __micro_speech_quantized_tflite, kMicroSpeechLabels,
+   std::size(kMicroSpeechLabels), &g_speech_op_resolver,
+   [] { return RegisterSpeechOps(g_speech_op_resolver); },
+   g_micro_speech_persistent, kSpeechPersistentSize},
+};
+
+constexpr int kSpeechModelCount = std::size(kSpeechModels);
+
+constexpr int MaxCategoryCount(void) {
+  int count = 0;
+  for (const SpeechModel& model : kSpeechModels) {
+    count = std::max(count, model.category_count);
+  }
+  return count;
+}
+
+constexpr int kMaxCategoryCount = MaxCategoryCount();
+
+// Index of the first keyword in the category lists
+constexpr int kFirstKeyword = 2;
+
+#ifdef CFG_SPEECH_CASCADE
+static_assert(CFG_SPEECH_CASCADE_GATE < kSpeechModelCount,
+              "CFG_SPEECH_CASCADE_GATE is not a registered model");
+#endif
+
+// Posterior history for the smoothing stage, kept in the quantized domain
+constexpr int kAverageCount = CFG_RECOGNIZE_AVERAGE_COUNT;
+
+struct Recognizer {
+  int8_t posteriors[kAverageCount][kMaxCategoryCount];
+  int32_t sums[kMaxCategoryCount];
+  int head;
+  int fill;
+  int previous_top;
+  int since_top;
+};
+
+// Added once, the resolvers reject duplicate registrations on a rebuild
+static bool g_ops_registered = false;
+
+// The interpreters are constructed in place rather than on the heap, next to
+// their persistent regions. The pointers stay in MEM1 and are cleared when
+// the storage is lost.
+struct alignas(tflite::MicroInterpreter) InterpreterStorage {
+  uint8_t bytes[sizeof(tflite::MicroInterpreter)];
+};
+#ifndef CFG_NATIVE_FRONTEND
+static InterpreterStorage INFERENCE_STATE g_preproc_storage;
 static tflite::MicroInterpreter* g_preproc_interpreter = nullptr;
-static tflite::MicroInterpreter* g_speech_interpreter = nullptr;
-
-#define RETURN_IF_ERROR(expr) \
-  do { \
-    TfLiteStatus _status = (expr); \
-    if (_status != kTfLiteOk) return _status; \
-  } while (0)
-
-static TfLiteStatus RegisterPreprocessorOps(PreprocessorOpResolver& resolver) {
-  RETURN_IF_ERROR(resolver.AddReshape());
-  RETURN_IF_ERROR(resolver.AddCast());
-  RETURN_IF_ERROR(resolver.AddStridedSlice());
-  RETURN_IF_ERROR(resolver.AddConcatenation());
-  RETURN_IF_ERROR(resolver.AddMul());
-  RETURN_IF_ERROR(resolver.AddAdd());
-  RETURN_IF_ERROR(resolver.AddDiv());
-  RETURN_IF_ERROR(resolver.AddMinimum());
-  RETURN_IF_ERROR(resolver.AddMaximum());
-  RETURN_IF_ERROR(resolver.AddWindow());
-  RETURN_IF_ERROR(resolver.AddFftAutoScale());
-  RETURN_IF_ERROR(resolver.AddRfft());
-  RETURN_IF_ERROR(resolver.AddEnergy());
-  RETURN_IF_ERROR(resolver.AddFilterBank());
-  RETURN_IF_ERROR(resolver.AddFilterBankSquareRoot());
-  RETURN_IF_ERROR(resolver.AddFilterBankSpectralSubtraction());
-  RETURN_IF_ERROR(resolver.AddPCAN());
-  RETURN_IF_ERROR(resolver.AddFilterBankLog());
-  return kTfLiteOk;
-}
-
-static TfLiteStatus RegisterSpeechOps(SpeechOpResolver& resolver) {
-  RETURN_IF_ERROR(resolver.AddReshape());
-  RETURN_IF_ERROR(resolver.AddFullyConnected());
-  RETURN_IF_ERROR(resolver.AddDepthwiseConv2D());
-  RETURN_IF_ERROR(resolver.AddSoftmax());
-  return kTfLiteOk;
+#endif
+static InterpreterStorage INFERENCE_STATE g_speech_storage[kSpeechModelCount];
+
+static tflite::MicroInterpreter* g_speech_interpreters[kSpeechModelCount];
+
+static Recognizer g_recognizers[kSpeechModelCount];
+
+// Model used by inference_speech_run() and the category functions
+static int g_speech_model = 0;
+
+// Top category of the last speech run, before smoothing
+static int g_last_top = INFERENCE_ERROR;
+
+#ifdef CFG_PROFILER
+static CycleProfiler g_preproc_profiler("preproc");
+static CycleProfiler g_micro_speech_profiler("micro_speech");
+static CycleProfiler* const g_speech_profilers[] = {
+  &g_micro_speech_profiler,
+};
+static_assert(std::size(g_speech_profilers) == kSpeechModelCount,
+              "one profiler per speech model");
+#define PREPROC_PROFILER (&g_preproc_profiler)
+#define SPEECH_PROFILER(model) (g_speech_profilers[model])
+#else
+#define PREPROC_PROFILER nullptr
+#define SPEECH_PROFILER(model) nullptr
+#endif
+
+static void ResetRecognizer(Recognizer& recognizer) {
+  std::fill_n(recognizer.sums, kMaxCategoryCount, 0);
+  recognizer.head = 0;
+  recognizer.fill = 0;
+  recognizer.previous_top = 0;
+  recognizer.since_top = CFG_RECOGNIZE_SUPPRESSION_COUNT;
 }
 
-extern "C" void inference_preproc_init(void) {
-  // Initialize preprocessor interpreter
-  const tflite::Model* preproc_model = tflite::GetModel(__audio_preprocessor_int8_tflite);
-  if (preproc_model->version() != TFLITE_SCHEMA_VERSION) {
-    printf("Preprocessor model version mismatch\n");
+// Smooth the scores over the last runs and report a command when its average
+// crosses the threshold, unless the same command was reported within the
+// suppression period or it is silence or unknown. The output scale is
+// positive, so int8 scores order like the probabilities they encode and no
+// dequantization is needed.
+static int RecognizeCommand(Recognizer& r, int category_count,
+                            const int8_t* scores, int32_t zero_point) {
+  int8_t* slot = r.posteriors[r.head];
+  for (int i = 0; i < category_count; ++i) {
+    if (r.fill == kAverageCount) r.sums[i] -= slot[i];
+    r.sums[i] += scores[i];
+    slot[i] = scores[i];
+  }
+  if (++r.head == kAverageCount) r.head = 0;
+  if (r.fill < kAverageCount) r.fill++;
+  if (r.since_top < CFG_RECOGNIZE_SUPPRESSION_COUNT) r.since_top++;
+
+  if (r.fill < CFG_RECOGNIZE_MIN_COUNT) return INFERENCE_NO_COMMAND;
+
+  int top = 0;
+  for (int i = 1; i < category_count; ++i) {
+    if (r.sums[i] > r.sums[top]) top = i;
+  }
+
+  // Compare the average against the threshold without dividing
+  const int32_t threshold = (zero_point + CFG_RECOGNIZE_THRESHOLD) * r.fill;
+  if (r.sums[top] <= threshold) return INFERENCE_NO_COMMAND;
+  if (top == r.previous_top && r.since_top < CFG_RECOGNIZE_SUPPRESSION_COUNT) {
+    return INFERENCE_NO_COMMAND;
+  }
+
+  r.previous_top = top;
+  r.since_top = 0;
+
+  // Silence and unknown still restart the suppression period, but are not
+  // commands
+  if (top < kFirstKeyword) return INFERENCE_NO_COMMAND;
+  return top;
+}
+
+static void RegisterOps(void) {
+  if (g_ops_registered) return;
+#ifndef CFG_NATIVE_FRONTEND
+  if (RegisterPreprocessorOps(g_preproc_op_resolver) != kTfLiteOk) {
+    printf("Failed to register operators\n");
     return;
   }
-  RegisterPreprocessorOps(g_preproc_op_resolver);
-  g_preproc_interpreter = new tflite::MicroInterpreter(
-      preproc_model, g_preproc_op_resolver, g_preproc_arena, kPreprocArenaSize);
-  if (g_preproc_interpreter->AllocateTensors() != kTfLiteOk) {
-    printf("Failed to allocate preprocessor tensors\n");
+#endif
+  for (const SpeechModel& model : kSpeechModels) {
+    if (model.register_ops() != kTfLiteOk) {
+      printf("Failed to register %s operators\n", model.name);
+      return;
+    }
+  }
+  for (Recognizer& recognizer : g_recognizers) ResetRecognizer(recognizer);
+  g_ops_registered = true;
+}
+
+// Build an interpreter in its static storage, returns nullptr on failure
+static tflite::MicroInterpreter* CreateInterpreter(
+    const unsigned char* model_data, const tflite::MicroOpResolver& resolver,
+    uint8_t* persistent, size_t persistent_size, InterpreterStorage& storage,
+    tflite::MicroProfilerInterface* profiler, const char* name) {
+  const tflite::Model* model = tflite::GetModel(model_data);
+  if (model->version() != TFLITE_SCHEMA_VERSION) {
+    printf("%s model version mismatch\n", name);
+    return nullptr;
+  }
+  tflite::MicroAllocator* allocator = tflite::MicroAllocator::Create(
+      persistent, persistent_size, g_scratch_arena, kScratchArenaSize);
+  if (!allocator) {
+    printf("Failed to create %s allocator\n", name);
+    return nullptr;
+  }
+  tflite::MicroInterpreter* interpreter = new (storage.bytes)
+      tflite::MicroInterpreter(model, resolver, allocator, nullptr, profiler);
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
+    printf("Failed to allocate %s tensors\n", name);
+    return nullptr;
+  }
+  return interpreter;
+}
+
+// The interpreters are built on first use, and again after
+// inference_suspend() dropped them
+#ifndef CFG_NATIVE_FRONTEND
+static tflite::MicroInterpreter* PreprocInterpreter(void) {
+  if (!g_preproc_interpreter) {
+    RegisterOps();
+    g_preproc_interpreter = CreateInterpreter(
+        __audio_preprocessor_int8_tflite, g_preproc_op_resolver,
+        g_preproc_persistent, kPreprocPersistentSize, g_preproc_storage,
+        PREPROC_PROFILER, "preprocessor");
+  }
+  return g_preproc_interpreter;
+}
+#endif
+
+static tflite::MicroInterpreter* SpeechInterpreter(int index) {
+  if (!g_speech_interpreters[index]) {
+    const SpeechModel& model = kSpeechModels[index];
+    RegisterOps();
+    g_speech_interpreters[index] = CreateInterpreter(
+        model.data, *model.resolver, model.persistent, model.persistent_size,
+        g_speech_storage[index], SPEECH_PROFILER(index), model.name);
+  }
+  return g_speech_interpreters[index];
+}
+
+// Invoke a speech model on the feature window, returns its int8 scores or
+// nullptr on failure
+static TfLiteTensor* InvokeSpeech(int index) {
+  tflite::MicroInterpreter* interpreter = SpeechInterpreter(index);
+  if (!interpreter) {
+    printf("Interpreter not initialized\n");
+    return nullptr;
+  }
+
+  // Unroll the window from its oldest frame
+  TfLiteTensor* speech_in = interpreter->input(0);
+  int8_t* speech_data = tflite::GetTensorData<int8_t>(speech_in);
+  speech_data = std::copy_n(&g_features[g_feature_head][0],
+      (CFG_FEATURE_COUNT - g_feature_head) * CFG_FEATURE_SIZE, speech_data);
+  std::copy_n(&g_features[0][0], g_feature_head * CFG_FEATURE_SIZE,
+              speech_data);
+  if (interpreter->Invoke() != kTfLiteOk) {
+    printf("%s inference failed\n", kSpeechModels[index].name);
+    return nullptr;
+  }
+
+  TfLiteTensor* speech_out = interpreter->output(0);
+  if (speech_out->type != kTfLiteInt8) {
+    printf("%s output is not int8\n", kSpeechModels[index].name);
+    return nullptr;
+  }
+  return speech_out;
+}
+
+static int TopCategory(const int8_t* scores, int category_count) {
+  int top = 0;
+  for (int i = 1; i < category_count; ++i) {
+    if (scores[i] > scores[top]) top = i;
+  }
+  return top;
+}
+
+extern "C" void inference_preproc_init(void) {
+#ifdef CFG_NATIVE_FRONTEND
+  if (frontend_init() != 0) {
+    printf("Failed to initialize the frontend\n");
     return;
   }
+  printf("preproc arena: none, native frontend\n");
+#else
+  tflite::MicroInterpreter* interpreter = PreprocInterpreter();
+  if (!interpreter) return;
+  printf("preproc arena: %u bytes\n",
+         (unsigned) interpreter->arena_used_bytes());
+#endif
 }
 
+// Builds every registered model, so that a switch never allocates
 extern "C" void inference_speech_init(void) {
-  // Initialize speech inference interpreter
-  const tflite::Model* speech_model = tflite::GetModel(__micro_speech_quantized_tflite);
-  if (speech_model->version() != TFLITE_SCHEMA_VERSION) {
-    printf("Speech model version mismatch\n");
+  for (int i = 0; i < kSpeechModelCount; ++i) {
+    tflite::MicroInterpreter* interpreter = SpeechInterpreter(i);
+    if (!interpreter) continue;
+    printf("%s arena: %u bytes\n", kSpeechModels[i].name,
+           (unsigned) interpreter->arena_used_bytes());
+  }
+}
+
+extern "C" int inference_speech_model_count(void) {
+  return kSpeechModelCount;
+}
+
+extern "C" const char* inference_speech_model_name(int model) {
+  if (model < 0 || model >= kSpeechModelCount) return "none";
+  return kSpeechModels[model].name;
+}
+
+extern "C" int inference_speech_select(int model) {
+  if (model < 0 || model >= kSpeechModelCount) return INFERENCE_ERROR;
+  if (model != g_speech_model) {
+    // Scores of the previous model mean nothing to the new one
+    ResetRecognizer(g_recognizers[model]);
+    g_speech_model = model;
+    g_last_top = INFERENCE_ERROR;
+  }
+  return 0;
+}
+
+extern "C" int inference_speech_selected(void) {
+  return g_speech_model;
+}
+
+extern "C" void inference_suspend(void) {
+#ifdef CFG_MEM_GATING_COLD
+  // The interpreters go down with MEM2, their destructors would only free
+  // operator state that is lost anyway
+#ifndef CFG_NATIVE_FRONTEND
+  g_preproc_interpreter = nullptr;
+#endif
+  std::fill_n(g_speech_interpreters, kSpeechModelCount, nullptr);
+#endif
+}
+
+extern "C" void inference_resume(void) {
+  // Nothing in the scratch region outlives an invocation, so a rebuild is
+  // only needed when the interpreters were in the gated bank
+#ifndef CFG_NATIVE_FRONTEND
+  PreprocInterpreter();
+#endif
+#ifdef CFG_SPEECH_CASCADE
+  SpeechInterpreter(CFG_SPEECH_CASCADE_GATE);
+#endif
+  SpeechInterpreter(g_speech_model);
+}
+
+extern "C" void inference_preproc_step(const int16_t* audio_frame) {
+#ifdef CFG_NATIVE_FRONTEND
+  if (frontend_init() != 0) {
+    printf("Frontend not initialized\n");
     return;
   }
-  RegisterSpeechOps(g_speech_op_resolver);
-  g_speech_interpreter = new tflite::MicroInterpreter(
-      speech_model, g_speech_op_resolver, g_speech_arena, kSpeechArenaSize);
-  if (g_speech_interpreter->AllocateTensors() != kTfLiteOk) {
-    printf("Failed to allocate speech tensors\n");
+
+  // Generate one feature frame into the rolling window, profiled as a
+  // single operator
+#ifdef CFG_PROFILER
+  const uint32_t event = g_preproc_profiler.BeginEvent("Frontend");
+#endif
+  frontend_run(audio_frame, g_features[g_feature_head]);
+#ifdef CFG_PROFILER
+  g_preproc_profiler.EndEvent(event);
+#endif
+#else
+  tflite::MicroInterpreter* interpreter = PreprocInterpreter();
+  if (!interpreter) {
+    printf("Interpreter not initialized\n");
     return;
   }
+
+  // Generate one feature frame into the rolling window
+  TfLiteTensor* in = interpreter->input(0);
+  std::copy_n(audio_frame, CFG_AUDIO_DURATION_COUNT,
+              tflite::GetTensorData<int16_t>(in));
+  if (interpreter->Invoke() != kTfLiteOk) {
+    printf("Preprocessor invoke failed\n");
+    return;
+  }
+  TfLiteTensor* out = interpreter->output(0);
+  std::copy_n(tflite::GetTensorData<int8_t>(out), CFG_FEATURE_SIZE,
+              g_features[g_feature_head]);
+#endif
+
+  if (++g_feature_head == CFG_FEATURE_COUNT) g_feature_head = 0;
+  if (g_feature_fill < CFG_FEATURE_COUNT) g_feature_fill++;
+}
+
+extern "C" int inference_preproc_ready(void) {
+  return g_feature_fill == CFG_FEATURE_COUNT;
 }
 
 extern "C" void inference_preproc_run(int16_t* audio_data, const size_t audio_data_size) {
-  if (!g_preproc_interpreter) {
+#ifdef CFG_NATIVE_FRONTEND
+  if (frontend_init() != 0) {
+    printf("Frontend not initialized\n");
+    return;
+  }
+#else
+  if (!PreprocInterpreter()) {
     printf("Interpreter not initialized\n");
     return;
   }
+#endif
+
+  // Restart the window, the whole buffer is converted in one go
+  g_feature_head = 0;
+  g_feature_fill = 0;
 
   // Generate features
   size_t remaining = audio_data_size;
   size_t offset = 0;
-  int feature_idx = 0;
-  while (remaining >= CFG_AUDIO_DURATION_COUNT && feature_idx < CFG_FEATURE_COUNT) {
-    TfLiteTensor* in = g_preproc_interpreter->input(0);
-    std::copy_n(audio_data + offset, CFG_AUDIO_DURATION_COUNT,
-                tflite::GetTensorData<int16_t>(in));
-    if (g_preproc_interpreter->Invoke() != kTfLiteOk) {
-      printf("Preprocessor invoke failed\n");
-      return;
-    }
-    TfLiteTensor* out = g_preproc_interpreter->output(0);
-    std::copy_n(tflite::GetTensorData<int8_t>(out), CFG_FEATURE_SIZE,
-                g_features[feature_idx]);
+  while (remaining >= CFG_AUDIO_DURATION_COUNT && !inference_preproc_ready()) {
+    inference_preproc_step(audio_data + offset);
     offset += CFG_AUDIO_STRIDE_COUNT;
     remaining -= CFG_AUDIO_STRIDE_COUNT;
-    feature_idx++;
   }
 }
 
+#ifdef CFG_SPEECH_CASCADE
+// The gate model passes a window on when its top category is a keyword
+// scoring above CFG_SPEECH_CASCADE_THRESHOLD. On a miss, the top category
+// of the gate is reported as silence or unknown.
+static bool RunGate(int* top) {
+  const SpeechModel& gate = kSpeechModels[CFG_SPEECH_CASCADE_GATE];
+  TfLiteTensor* out = InvokeSpeech(CFG_SPEECH_CASCADE_GATE);
+  if (!out) return true;
+
+  const int8_t* scores = tflite::GetTensorData<int8_t>(out);
+  const int gate_top = TopCategory(scores, gate.category_count);
+  const int32_t threshold =
+      out->params.zero_point + CFG_SPEECH_CASCADE_THRESHOLD;
+  if (gate_top >= kFirstKeyword && scores[gate_top] > threshold) return true;
+
+  *top = std::min(gate_top, kFirstKeyword - 1);
+  return false;
+}
+#endif
+
 extern "C" int inference_speech_run(void) {
-  if (!g_speech_interpreter) {
-    printf("Interpreter not initialized\n");
-    return -1;
-  }
+  const SpeechModel& model = kSpeechModels[g_speech_model];
+  Recognizer& recognizer = g_recognizers[g_speech_model];
 
-  // Run speech inference
-  TfLiteTensor* speech_in = g_speech_interpreter->input(0);
-  std::copy_n(&g_features[0][0], CFG_FEATURE_ELEMENT_COUNT,
-              tflite::GetTensorData<int8_t>(speech_in));
-  if (g_speech_interpreter->Invoke() != kTfLiteOk) {
-    printf("Speech inference failed\n");
-    return -1;
+#ifdef CFG_BENCHMARK
+  const uint32_t t0 = hal_timer1_read();
+#endif
+
+#ifdef CFG_SPEECH_CASCADE
+  // The smoothing history is restarted on a miss, older windows were
+  // silence as far as the gate could tell
+  if (g_speech_model != CFG_SPEECH_CASCADE_GATE && !RunGate(&g_last_top)) {
+    ResetRecognizer(recognizer);
+#ifdef CFG_BENCHMARK
+    bench_add(BENCH_SPEECH, hal_timer1_read() - t0);
+#endif
+    return INFERENCE_NO_COMMAND;
   }
+#endif
+
+  TfLiteTensor* speech_out = InvokeSpeech(g_speech_model);
+  if (!speech_out) return INFERENCE_ERROR;
+
+#ifdef CFG_BENCHMARK
+  const uint32_t t1 = hal_timer1_read();
+  bench_add(BENCH_SPEECH, t1 - t0);
+#endif
 
   // Decode output
-  TfLiteTensor* speech_out = g_speech_interpreter->output(0);
-  float scale = speech_out->params.scale;
-  int zero_point = speech_out->params.zero_point;
-  float best_score = -1e6f;
-  int best_index = 0;
-  const int8_t* out_data = tflite::GetTensorData<int8_t>(speech_out);
-  for (int i = 0; i < kCategoryCount; ++i) {
-    float score = (out_data[i] - zero_point) * scale;
-    if (score > best_score) {
-      best_score = score;
-      best_index = i;
-    }
-  }
+  const int8_t* scores = tflite::GetTensorData<int8_t>(speech_out);
+  g_last_top = TopCategory(scores, model.category_count);
+
+  const int command = RecognizeCommand(recognizer, model.category_count,
+                                       scores, speech_out->params.zero_point);
+
+#ifdef CFG_BENCHMARK
+  bench_add(BENCH_DECODE, hal_timer1_read() - t1);
+#endif
+
+  return command;
+}
+
+extern "C" int inference_speech_top(void) {
+  return g_last_top;
+}
+
+extern "C" int inference_category_count(void) {
+  return kSpeechModels[g_speech_model].category_count;
+}
+
+extern "C" const char* inference_category_label(int category) {
+  const SpeechModel& model = kSpeechModels[g_speech_model];
+  if (category < 0 || category >= model.category_count) return "none";
+  return model.labels[category];
+}
+
+#ifdef CFG_PROFILER
+extern "C" void inference_profile_dump(void) {
+  g_preproc_profiler.Dump();
+  for (const CycleProfiler* profiler : g_speech_profilers) profiler->Dump();
+}
 
-  return best_index;
+extern "C" void inference_profile_reset(void) {
+  g_preproc_profiler.Reset();
+  for (CycleProfiler* profiler : g_speech_profilers) profiler->Reset();
 }
+#endif
@@ -0,0 +1,101 @@
+#include "ingest.h"
+
+// Full-scale y^2 >> INGEST_ENERGY_SHIFT sums that fit in 32 bits
+#define INGEST_CHUNK 63
+
+_Static_assert((uint64_t) INGEST_CHUNK * ((32768 * 32768)
+    >> INGEST_ENERGY_SHIFT) <= UINT32_MAX,
+    "ingest chunk energy overflows");
+
+// Xpulp is only on CV32E40P, the LPCPU runs the plain version
+#if defined(CFG_XPULP) && !defined(CFG_LPCPU)
+#define INGEST_XPULP
+#endif
+
+static inline int32_t LPMEM_TEXT ingest_clip16(int32_t x)
+{
+#ifdef INGEST_XPULP
+    // cv.clip x, x, 16 saturates to [-2^15, 2^15 - 1] in one cycle, the
+    // immediate sits in the rs2 field
+    int32_t y;
+    asm(".insn r 0x2b, 0x3, 0x38, %0, %1, x16" : "=r"(y) : "r"(x));
+    return y;
+#else
+    if (x > 32767) x = 32767;
+    if (x < -32768) x = -32768;
+    return x;
+#endif
+}
+
+static inline uint32_t LPMEM_TEXT ingest_add_sat(uint32_t a, uint32_t b)
+{
+    uint32_t sum = a + b;
+    return sum < a ? UINT32_MAX : sum;
+}
+
+uint32_t LPMEM_TEXT ingest_block(ingest_hpf_t *hpf, const int16_t *in,
+    int16_t *out, size_t n)
+{
+    int32_t prev_in = hpf->prev_in;
+    int32_t prev_out = hpf->prev_out;
+    uint32_t energy = 0;
+
+    while (n) {
+        size_t len = n < INGEST_CHUNK ? n : INGEST_CHUNK;
+        uint32_t chunk = 0;
+
+        // The filter is recursive, one sample at a time. The chunk energy
+        // cannot overflow, it is saturated once per chunk only.
+        for (size_t i = 0; i < len; i++) {
+            int32_t x = in[i];
+            int32_t y = (x - prev_in) + ((prev_out * CFG_AUDIO_HPF) >> 15);
+
+            prev_in = x;
+            prev_out = y;
+
+            int32_t s = ingest_clip16(y);
+            out[i] = (int16_t) s;
+            chunk += (uint32_t) (s * s) >> INGEST_ENERGY_SHIFT;
+        }
+
+        energy = ingest_add_sat(energy, chunk);
+        in += len;
+        out += len;
+        n -= len;
+    }
+
+    hpf->prev_in = (int16_t) prev_in;
+    hpf->prev_out = prev_out;
+    return energy;
+}
+
+void LPMEM_TEXT ingest_power_add(ingest_power_t *power, uint32_t energy)
+{
+    uint32_t exp = power->exp;
+
+    // Round the block to the current exponent, then renormalize on carry
+    uint32_t add = exp < 32 ? energy >> exp : 0;
+    uint32_t mant = power->mant + add;
+
+    if (mant < add) {
+        mant = (mant >> 1) | 0x80000000u;
+        exp++;
+    }
+
+    power->mant = mant;
+    power->exp = exp;
+}
+
+int LPMEM_TEXT ingest_power_ge(const ingest_power_t *power,
+    uint32_t threshold)
+{
+    uint32_t exp = power->exp;
+
+    if (exp == 0) return power->mant >= threshold;
+    if (exp >= 32) return 1;
+
+    // Compare with the threshold rounded up to the exponent
+    uint32_t t = threshold >> exp;
+    if (threshold & ((1u << exp) - 1)) t++;
+    return power->mant >= t;
+}
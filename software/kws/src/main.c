@@ -3,32 +3,107 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
+#include "alloc.h"
+#include "audio.h"
+#include "bench.h"
 #include "cfg.h"
+#include "console.h"
 #include "hal.h"
 #include "inference.h"
 
 #define TIC() \
     do { t0 = hal_timer1_read(); } while (0)
 
+#ifdef CFG_BENCHMARK
+// Stage cycles go to the benchmark report, printing them would skew it
+#define TOC(label) \
+    do { } while (0)
+
+#define TOC_STAGE(label, stage) \
+    bench_add((stage), hal_timer1_read() - t0)
+#else
 #define TOC(label) \
     do { \
         uint32_t t1 = hal_timer1_read(); \
         printf("%s: %d cycles\n", (label), (int) (t1 - t0)); \
     } while (0)
 
-static volatile int16_t audio_buffer[CFG_AUDIO_DATA_SIZE];
-static volatile int16_t * volatile LPMEM_DATA audio_ptr = audio_buffer;
+#define TOC_STAGE(label, stage) \
+    TOC(label)
+#endif
+
 static volatile uint32_t t0;
 
+#ifndef CFG_AUDIO_PINGPONG
+static int16_t audio_window[CFG_AUDIO_CAPTURE_SIZE];
+
+static void audio_slide(size_t hop)
+{
+    memmove(audio_window, audio_window + hop,
+        (CFG_AUDIO_CAPTURE_SIZE - hop) * sizeof(audio_window[0]));
+}
+#endif
+
+// With the LPCPU and without deep sleep, CPU0 polls and never sleeps: no
+// sleep time nor wakeup is counted then
+#if defined(CFG_DEEP_SLEEP) || !defined(CFG_LPCPU)
+    #define AUDIO_WAIT_SLEEPS
+#endif
+
+static void audio_wait(void)
+{
+#if defined(CFG_BENCHMARK) && defined(AUDIO_WAIT_SLEEPS)
+    uint32_t t1 = hal_timer1_read();
+#endif
+
+#ifdef CFG_DEEP_SLEEP
+#ifdef CFG_STDOUT_IRQ
+    console_flush();
+#endif
+    deep_sleep();
+#elif !defined(CFG_LPCPU)
+    asm volatile("wfi");
+#endif
+
+#if defined(CFG_BENCHMARK) && defined(AUDIO_WAIT_SLEEPS)
+    bench_add(BENCH_SLEEP, hal_timer1_read() - t1);
+    bench_wakeup();
+#endif
+}
+
 int main() {
     volatile int result;
+#ifndef CFG_AUDIO_PINGPONG
+    size_t audio_fill = 0;
+    uint32_t audio_hops = 0;
+#endif
+    uint32_t overruns = 0;
+#if defined(CFG_STDOUT_IRQ) && !defined(CFG_STDOUT_BLOCK)
+    uint32_t dropped = 0;
+#endif
+#ifdef CFG_STREAMING
+    unsigned int frames = 0;
+#endif
+#ifdef CFG_PROFILER
+    unsigned int profiled = 0;
+#endif
+#ifdef CFG_MEM_GATING
+    bool mem2_on = true;
+#endif
 
     hal_uart0_init();
     hal_spi0_init();
     hal_timer0_init();
     hal_timer1_init();
+#if defined(CFG_MEM_GATING) || defined(CFG_BANK_PLACEMENT)
+    hal_mem2_resume();
+#endif
+#ifdef CFG_PROFILER_IMISS
+    hal_hpm3_init(HAL_HPM_IMISS);
+#endif
 
 #ifdef CFG_LPCPU
     hal_lpmem_init();
@@ -52,92 +127,156 @@ int main() {
     context_backup();
     context_restore_periph();
 
-    TIC();
+    // Capture runs continuously from here on, the window slides over the ring
+    // or, with CFG_AUDIO_PINGPONG, alternates between the two buffers
     hal_timer0_start();
     while(1) {
+#ifdef CFG_BENCHMARK
+        if (bench_done()) {
+            hal_timer0_stop();
+            bench_report();
+            while(1) asm volatile("wfi");
+        }
+#endif
 
-#ifdef CFG_DEEP_SLEEP
-        deep_sleep();
-#elif !defined(CFG_LPCPU)
-        asm volatile("wfi");
+#ifdef CFG_AUDIO_PINGPONG
+        int active;
+        int16_t *window = audio_window_acquire(&active);
+
+        if (!window) {
+            audio_wait();
+            continue;
+        }
+#else
+        audio_fill += audio_read(audio_window + audio_fill,
+                                 CFG_AUDIO_CAPTURE_SIZE - audio_fill);
+
+        if (audio_fill < CFG_AUDIO_CAPTURE_SIZE) {
+            audio_wait();
+            continue;
+        }
+
+        // At least one hop since the last detection was loud enough
+        uint32_t hops = audio_active_hops();
+        int active = hops != audio_hops;
+        int16_t *window = audio_window;
 #endif
 
-        if (audio_ptr == audio_buffer + CFG_AUDIO_DATA_SIZE) {
-            TOC("recording");
+#ifdef CFG_STREAMING
+        TIC();
+        inference_preproc_step(window);
+        TOC_STAGE("inference_preproc_step", BENCH_PREPROC);
 
-            TIC();
-            inference_preproc_run((int16_t *) audio_buffer,
-                                  CFG_AUDIO_DATA_SIZE);
-            TOC("inference_preproc_run");
+        audio_slide(CFG_AUDIO_STRIDE_COUNT);
+        audio_fill -= CFG_AUDIO_STRIDE_COUNT;
+
+        if (++frames < CFG_AUDIO_WINDOW_HOP / CFG_AUDIO_STRIDE_COUNT) continue;
+        frames = 0;
+        audio_hops = hops;
 
+        if (active && inference_preproc_ready()) {
             TIC();
             result = inference_speech_run();
             TOC("inference_speech_run");
 
-            printf("result: %d\n", result);
-
-            audio_ptr = audio_buffer;
-
+            if (result >= 0) {
+#ifndef CFG_BENCHMARK
+                printf("result: %d\n", result);
+#else
+                bench_result(result);
+#endif
+            }
+        }
+#else
+#ifdef CFG_MEM_GATING
+        // MEM2 stays down until a hop is loud enough, compare the resume
+        // cycles with the inference_*_init() ones
+        if (active && !mem2_on) {
             TIC();
-            hal_timer0_start();
+            hal_mem2_resume();
+            inference_resume();
+            TOC("inference_resume");
+            mem2_on = true;
+        } else if (!active && mem2_on) {
+            inference_suspend();
+            hal_mem2_stop();
+            mem2_on = false;
         }
-    }
+#endif
 
-    return 0;
-}
+        if (active) {
+            TIC();
+            inference_preproc_run(window, CFG_AUDIO_DATA_SIZE);
+            TOC_STAGE("inference_preproc_run", BENCH_PREPROC);
+        }
 
-void LPMEM_TEXT main_lpcpu(void)
-{
-    while(1) {
-        asm volatile("wfi");
-        // RAL.LSPA.UART[0]->DR = '@';
-    }
-}
+#ifdef CFG_AUDIO_PINGPONG
+        // The features are computed, hand the buffer back before the speech
+        // model runs so the producer always has one to fill
+        audio_window_release();
+#else
+        audio_hops = hops;
+        audio_slide(CFG_AUDIO_WINDOW_HOP);
+        audio_fill -= CFG_AUDIO_WINDOW_HOP;
+#endif
 
-// IRQ ========================================================================
+        if (active) {
+            TIC();
+            result = inference_speech_run();
+            TOC("inference_speech_run");
 
-void __attribute__((interrupt)) LPMEM_TEXT
-#ifdef CFG_LPCPU
-    lpcpu_handler(void)
+            if (result >= 0) {
+#ifndef CFG_BENCHMARK
+                printf("result: %d\n", result);
 #else
-    default_handler(void)
+                bench_result(result);
+#endif
+            }
+        }
 #endif
-{
-    if(!RAL.LSPA.TIMER[0]->ER) return;
-    RAL.LSPA.TIMER[0]->ER = ~0;
-
-    static int16_t LPMEM_DATA prev_in = 0;
-    static int32_t LPMEM_DATA prev_out = 0;
-    static int64_t LPMEM_DATA power_sum = 0;
 
-    int16_t in = hal_spi0_read();
+#ifdef CFG_ALLOCATOR
+        alloc_scratch_reset();
+#endif
 
-    // High-pass filter: y[n] = x[n] - x[n-1] + R*y[n-1]
-    int32_t out = (int32_t)(in - prev_in) + ((prev_out * CFG_AUDIO_HPF) >> 15);
-    prev_in = in;
-    prev_out = out;
+#ifdef CFG_PROFILER
+        if (++profiled == CFG_PROFILER_PERIOD) {
+            inference_profile_dump();
+            inference_profile_reset();
+#ifdef CFG_ALLOCATOR
+            alloc_report();
+#endif
+            profiled = 0;
+        }
+#endif
 
-    if (out > 32767) out = 32767;
-    if (out < -32768) out = -32768;
+#if defined(CFG_LPCPU) && defined(CFG_VAD)
+        if (active) {
+            printf("cpu0 idle: %d/%d frames\n",
+                (int) audio_idle_frames(), (int) audio_frames());
+        }
+#endif
 
-    if (audio_ptr != audio_buffer + CFG_AUDIO_DATA_SIZE) {
-        int16_t s = (int16_t)out;
-        *audio_ptr++ = in;
-        power_sum += (int64_t)s * s;
+        if (audio_overruns() != overruns) {
+            overruns = audio_overruns();
+            printf("overruns: %d\n", (int) overruns);
+        }
 
-        if (audio_ptr == audio_buffer + CFG_AUDIO_DATA_SIZE) {
-            if (power_sum >= CFG_AUDIO_THRESHOLD) {
-                hal_timer0_stop();
-#ifdef CFG_LPCPU
-                hal_cpu0_resume();
-#endif
-            } else {
-                audio_ptr = audio_buffer;
-            }
-            // Reset for next collection
-            power_sum = 0;
-            prev_in = 0;
-            prev_out = 0;
+#if defined(CFG_STDOUT_IRQ) && !defined(CFG_STDOUT_BLOCK)
+        if (console_dropped() != dropped) {
+            dropped = console_dropped();
+            printf("stdout dropped: %d\n", (int) dropped);
         }
+#endif
+    }
+
+    return 0;
+}
+
+void LPMEM_TEXT main_lpcpu(void)
+{
+    while(1) {
+        asm volatile("wfi");
+        // RAL.LSPA.UART[0]->DR = '@';
     }
 }
@@ -0,0 +1,401 @@
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/micro/kernels/depthwise_conv.h"
+#include "tensorflow/lite/micro/kernels/fully_connected.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+#include "cfg.h"
+#include "opt_kernels.h"
+
+namespace {
+
+// The reference registrations, used for Init/Prepare and as fallback
+TFLMRegistration g_fc_reference;
+TFLMRegistration g_dw_reference;
+
+// Per-node data. The reference data must stay first, the reference Prepare
+// and Eval cast user_data to it.
+struct OpDataFullyConnectedOpt {
+  tflite::OpDataFullyConnected reference;
+  bool optimized;
+  // bias + input_offset * sum(row) + depth * filter_offset * input_offset
+  int32_t* row_offsets;
+};
+
+struct OpDataDepthwiseConvOpt {
+  tflite::OpDataConv reference;
+  bool optimized;
+  // Filter repacked per output channel, rows padded to a word
+  int8_t* filter;
+  int filter_stride;
+  // bias + input_offset * sum(filter) for windows inside the image
+  int32_t* interior_bias;
+};
+
+inline uint32_t LoadWord(const int8_t* p) {
+  uint32_t w;
+#ifdef CFG_XPULP
+  // CV32E40P splits misaligned loads in hardware
+  asm("lw %0, 0(%1)" : "=r"(w) : "r"(p), "m"(*(const int8_t(*)[4]) p));
+#else
+  memcpy(&w, __builtin_assume_aligned(p, 4), sizeof(w));
+#endif
+  return w;
+}
+
+// acc + sum(a[i] * b[i]) over n int8 pairs, a must be word aligned. Four
+// pairs per iteration: with CFG_XPULP through one cv.sdotsp.b, otherwise the
+// bytes of a are unpacked from one word load (SWAR).
+inline int32_t DotInt8(const int8_t* a, const int8_t* b, int n, int32_t acc) {
+  int i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    const uint32_t wa = LoadWord(a + i);
+#ifdef CFG_XPULP
+    const uint32_t wb = LoadWord(b + i);
+    asm(".insn r 0x7b, 0x1, 0x5c, %0, %1, %2"
+        : "+r"(acc) : "r"(wa), "r"(wb));
+#else
+    acc += (static_cast<int32_t>(wa << 24) >> 24) * b[i + 0];
+    acc += (static_cast<int32_t>(wa << 16) >> 24) * b[i + 1];
+    acc += (static_cast<int32_t>(wa << 8) >> 24) * b[i + 2];
+    acc += (static_cast<int32_t>(wa) >> 24) * b[i + 3];
+#endif
+  }
+
+  for (; i < n; i++) acc += a[i] * b[i];
+
+  return acc;
+}
+
+inline int8_t Requantize(int32_t acc, int32_t multiplier, int shift,
+                         int32_t offset, int32_t act_min, int32_t act_max) {
+  acc = tflite::MultiplyByQuantizedMultiplier(acc, multiplier, shift);
+  acc += offset;
+  if (acc < act_min) acc = act_min;
+  if (acc > act_max) acc = act_max;
+  return static_cast<int8_t>(acc);
+}
+
+bool IsPerTensor(const TfLiteTensor* tensor) {
+  if (tensor->quantization.type != kTfLiteAffineQuantization) return false;
+  const auto* quant = static_cast<const TfLiteAffineQuantization*>(
+      tensor->quantization.params);
+  return quant->scale->size == 1;
+}
+
+// FullyConnected =============================================================
+
+void* FullyConnectedInitOpt(TfLiteContext* context, const char* buffer,
+                            size_t length) {
+  return context->AllocatePersistentBuffer(context,
+                                           sizeof(OpDataFullyConnectedOpt));
+}
+
+TfLiteStatus FullyConnectedPrepareOpt(TfLiteContext* context,
+                                      TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(g_fc_reference.prepare(context, node));
+
+  auto* data = static_cast<OpDataFullyConnectedOpt*>(node->user_data);
+  tflite::MicroContext* micro_context = tflite::GetMicroContext(context);
+
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(
+      node, tflite::kFullyConnectedInputTensor);
+  TfLiteTensor* filter = micro_context->AllocateTempInputTensor(
+      node, tflite::kFullyConnectedWeightsTensor);
+  TfLiteTensor* bias = micro_context->AllocateTempInputTensor(
+      node, tflite::kFullyConnectedBiasTensor);
+  TfLiteTensor* output = micro_context->AllocateTempOutputTensor(
+      node, tflite::kFullyConnectedOutputTensor);
+
+  const int depth = filter->dims->data[filter->dims->size - 1];
+  const int rows = filter->dims->data[0];
+  const int8_t* filter_data = tflite::GetTensorData<int8_t>(filter);
+
+  data->optimized = input->type == kTfLiteInt8 &&
+                    filter->type == kTfLiteInt8 &&
+                    output->type == kTfLiteInt8 &&
+                    (bias == nullptr || bias->type == kTfLiteInt32) &&
+                    IsPerTensor(filter) && depth % 4 == 0 &&
+                    (reinterpret_cast<uintptr_t>(filter_data) & 3) == 0;
+
+  if (data->optimized) {
+    const int32_t input_offset = -data->reference.input_zero_point;
+    const int32_t filter_offset = -data->reference.filter_zero_point;
+    const int32_t* bias_data =
+        bias ? tflite::GetTensorData<int32_t>(bias) : nullptr;
+
+    data->row_offsets = static_cast<int32_t*>(
+        context->AllocatePersistentBuffer(context, rows * sizeof(int32_t)));
+    if (data->row_offsets == nullptr) return kTfLiteError;
+
+    for (int r = 0; r < rows; r++) {
+      int32_t sum = 0;
+      for (int d = 0; d < depth; d++) sum += filter_data[r * depth + d];
+      data->row_offsets[r] = (bias_data ? bias_data[r] : 0) +
+                             input_offset * sum +
+                             depth * filter_offset * input_offset;
+    }
+  }
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(filter);
+  if (bias) micro_context->DeallocateTempTfLiteTensor(bias);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+HOT_TEXT TfLiteStatus FullyConnectedEvalOpt(TfLiteContext* context,
+                                             TfLiteNode* node) {
+  const auto* data = static_cast<const OpDataFullyConnectedOpt*>(
+      node->user_data);
+  if (!data->optimized) return g_fc_reference.invoke(context, node);
+
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(
+      context, node, tflite::kFullyConnectedInputTensor);
+  const TfLiteEvalTensor* filter = tflite::micro::GetEvalInput(
+      context, node, tflite::kFullyConnectedWeightsTensor);
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(
+      context, node, tflite::kFullyConnectedOutputTensor);
+
+  const tflite::RuntimeShape output_shape =
+      tflite::micro::GetTensorShape(output);
+  const tflite::RuntimeShape filter_shape =
+      tflite::micro::GetTensorShape(filter);
+  const int output_dims = output_shape.DimensionsCount();
+  const int batches = tflite::FlatSizeSkipDim(output_shape, output_dims - 1);
+  const int output_depth = output_shape.Dims(output_dims - 1);
+  const int depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int8_t* filter_data = tflite::micro::GetTensorData<int8_t>(filter);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  const tflite::OpDataFullyConnected& ref = data->reference;
+  const int32_t filter_offset = -ref.filter_zero_point;
+
+  for (int b = 0; b < batches; b++) {
+    const int8_t* x = input_data + b * depth;
+
+    // Only needed for asymmetric filters, which int8 models rarely use
+    int32_t input_term = 0;
+    if (filter_offset != 0) {
+      for (int d = 0; d < depth; d++) input_term += x[d];
+      input_term *= filter_offset;
+    }
+
+    for (int r = 0; r < output_depth; r++) {
+      int32_t acc = DotInt8(filter_data + r * depth, x, depth,
+                            data->row_offsets[r] + input_term);
+      output_data[b * output_depth + r] = Requantize(
+          acc, ref.output_multiplier, ref.output_shift, ref.output_zero_point,
+          ref.output_activation_min, ref.output_activation_max);
+    }
+  }
+
+  return kTfLiteOk;
+}
+
+// DepthwiseConv2D ============================================================
+
+void* DepthwiseConvInitOpt(TfLiteContext* context, const char* buffer,
+                           size_t length) {
+  return context->AllocatePersistentBuffer(context,
+                                           sizeof(OpDataDepthwiseConvOpt));
+}
+
+TfLiteStatus DepthwiseConvPrepareOpt(TfLiteContext* context,
+                                     TfLiteNode* node) {
+  TF_LITE_ENSURE_STATUS(g_dw_reference.prepare(context, node));
+
+  auto* data = static_cast<OpDataDepthwiseConvOpt*>(node->user_data);
+  const auto& params =
+      *static_cast<const TfLiteDepthwiseConvParams*>(node->builtin_data);
+  tflite::MicroContext* micro_context = tflite::GetMicroContext(context);
+
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(
+      node, tflite::kDepthwiseConvInputTensor);
+  TfLiteTensor* filter = micro_context->AllocateTempInputTensor(
+      node, tflite::kDepthwiseConvWeightsTensor);
+  TfLiteTensor* bias = micro_context->AllocateTempInputTensor(
+      node, tflite::kDepthwiseConvBiasTensor);
+
+  // Only single-channel inputs are covered, as in the KWS model: the window
+  // rows are then contiguous in memory
+  data->optimized = input->type == kTfLiteInt8 &&
+                    filter->type == kTfLiteInt8 &&
+                    (bias == nullptr || bias->type == kTfLiteInt32) &&
+                    input->dims->data[3] == 1 &&
+                    params.dilation_width_factor == 1 &&
+                    params.dilation_height_factor == 1;
+
+  if (data->optimized) {
+    const int filter_height = filter->dims->data[1];
+    const int filter_width = filter->dims->data[2];
+    const int channels = filter->dims->data[3];
+    const int stride = (filter_width + 3) & ~3;
+    const int32_t input_offset = -input->params.zero_point;
+    const int8_t* filter_data = tflite::GetTensorData<int8_t>(filter);
+    const int32_t* bias_data =
+        bias ? tflite::GetTensorData<int32_t>(bias) : nullptr;
+
+    data->filter_stride = stride;
+    data->filter = static_cast<int8_t*>(context->AllocatePersistentBuffer(
+        context, channels * filter_height * stride));
+    data->interior_bias = static_cast<int32_t*>(
+        context->AllocatePersistentBuffer(context, channels * sizeof(int32_t)));
+    if (data->filter == nullptr || data->interior_bias == nullptr) {
+      return kTfLiteError;
+    }
+
+    memset(data->filter, 0, channels * filter_height * stride);
+    for (int c = 0; c < channels; c++) {
+      int32_t sum = 0;
+      for (int fy = 0; fy < filter_height; fy++) {
+        for (int fx = 0; fx < filter_width; fx++) {
+          const int8_t f =
+              filter_data[(fy * filter_width + fx) * channels + c];
+          data->filter[(c * filter_height + fy) * stride + fx] = f;
+          sum += f;
+        }
+      }
+      data->interior_bias[c] = (bias_data ? bias_data[c] : 0) +
+                               input_offset * sum;
+    }
+  }
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(filter);
+  if (bias) micro_context->DeallocateTempTfLiteTensor(bias);
+  return kTfLiteOk;
+}
+
+HOT_TEXT TfLiteStatus DepthwiseConvEvalOpt(TfLiteContext* context,
+                                            TfLiteNode* node) {
+  const auto* data = static_cast<const OpDataDepthwiseConvOpt*>(
+      node->user_data);
+  if (!data->optimized) return g_dw_reference.invoke(context, node);
+
+  const auto& params =
+      *static_cast<const TfLiteDepthwiseConvParams*>(node->builtin_data);
+  const tflite::DepthwiseParams op_params =
+      tflite::DepthwiseConvParamsQuantized(params, data->reference);
+
+  const TfLiteEvalTensor* input = tflite::micro::GetEvalInput(
+      context, node, tflite::kDepthwiseConvInputTensor);
+  const TfLiteEvalTensor* filter = tflite::micro::GetEvalInput(
+      context, node, tflite::kDepthwiseConvWeightsTensor);
+  const TfLiteEvalTensor* bias = tflite::micro::GetEvalInput(
+      context, node, tflite::kDepthwiseConvBiasTensor);
+  TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(
+      context, node, tflite::kDepthwiseConvOutputTensor);
+
+  const tflite::RuntimeShape input_shape =
+      tflite::micro::GetTensorShape(input);
+  const tflite::RuntimeShape filter_shape =
+      tflite::micro::GetTensorShape(filter);
+  const tflite::RuntimeShape output_shape =
+      tflite::micro::GetTensorShape(output);
+
+  const int batches = input_shape.Dims(0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int channels = output_shape.Dims(3);
+  const int stride = data->filter_stride;
+
+  const int8_t* input_data = tflite::micro::GetTensorData<int8_t>(input);
+  const int32_t* bias_data =
+      tflite::micro::GetOptionalTensorData<int32_t>(bias);
+  int8_t* output_data = tflite::micro::GetTensorData<int8_t>(output);
+
+  const int32_t* multiplier = data->reference.per_channel_output_multiplier;
+  const int32_t* shift = data->reference.per_channel_output_shift;
+
+  for (int b = 0; b < batches; b++) {
+    const int8_t* image = input_data + b * input_height * input_width;
+
+    for (int out_y = 0; out_y < output_height; out_y++) {
+      const int y0 = out_y * op_params.stride_height
+                     - op_params.padding_values.height;
+      const int fy0 = y0 < 0 ? -y0 : 0;
+      const int fy1 = y0 + filter_height > input_height
+                      ? input_height - y0 : filter_height;
+
+      for (int out_x = 0; out_x < output_width; out_x++) {
+        const int x0 = out_x * op_params.stride_width
+                       - op_params.padding_values.width;
+        const int fx0 = x0 < 0 ? -x0 : 0;
+        const int fx1 = x0 + filter_width > input_width
+                        ? input_width - x0 : filter_width;
+        const bool interior = fy0 == 0 && fy1 == filter_height &&
+                              fx0 == 0 && fx1 == filter_width;
+
+        int8_t* out = output_data +
+            ((b * output_height + out_y) * output_width + out_x) * channels;
+
+        for (int c = 0; c < channels; c++) {
+          const int8_t* f = data->filter + c * filter_height * stride;
+          int32_t acc;
+
+          if (interior) {
+            acc = data->interior_bias[c];
+            for (int fy = 0; fy < filter_height; fy++) {
+              acc = DotInt8(f + fy * stride,
+                            image + (y0 + fy) * input_width + x0,
+                            filter_width, acc);
+            }
+          } else {
+            // Window clipped by the padding, as the reference kernel
+            acc = bias_data ? bias_data[c] : 0;
+            for (int fy = fy0; fy < fy1; fy++) {
+              const int8_t* row = image + (y0 + fy) * input_width + x0;
+              for (int fx = fx0; fx < fx1; fx++) {
+                acc += f[fy * stride + fx] *
+                       (row[fx] + op_params.input_offset);
+              }
+            }
+          }
+
+          out[c] = Requantize(acc, multiplier[c], shift[c],
+                              op_params.output_offset,
+                              op_params.quantized_activation_min,
+                              op_params.quantized_activation_max);
+        }
+      }
+    }
+  }
+
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TFLMRegistration Register_FULLY_CONNECTED_OPT() {
+  g_fc_reference = tflite::Register_FULLY_CONNECTED();
+
+  TFLMRegistration registration = g_fc_reference;
+  registration.init = FullyConnectedInitOpt;
+  registration.prepare = FullyConnectedPrepareOpt;
+  registration.invoke = FullyConnectedEvalOpt;
+  return registration;
+}
+
+TFLMRegistration Register_DEPTHWISE_CONV_2D_OPT() {
+  g_dw_reference = tflite::Register_DEPTHWISE_CONV_2D();
+
+  TFLMRegistration registration = g_dw_reference;
+  registration.init = DepthwiseConvInitOpt;
+  registration.prepare = DepthwiseConvPrepareOpt;
+  registration.invoke = DepthwiseConvEvalOpt;
+  return registration;
+}
@@ -0,0 +1,67 @@
+#include <cstdio>
+#include <cstring>
+
+#include "profiler.h"
+
+extern "C" {
+#include "hal.h"
+}
+
+uint32_t CycleProfiler::BeginEvent(const char* tag) {
+  uint32_t i;
+
+  // Tags are the static operator names, compare pointers first
+  for (i = 0; i < count_; i++) {
+    if (entries_[i].tag == tag || strcmp(entries_[i].tag, tag) == 0) break;
+  }
+
+  if (i == count_) {
+    if (count_ == kMaxTags) return kMaxTags;
+    entries_[count_++].tag = tag;
+  }
+
+#ifdef CFG_PROFILER_IMISS
+  entries_[i].imiss_start = hal_hpm3_read();
+#endif
+  entries_[i].start = hal_timer1_read();
+  return i;
+}
+
+void CycleProfiler::EndEvent(uint32_t event_handle) {
+  uint32_t t1 = hal_timer1_read();
+#ifdef CFG_PROFILER_IMISS
+  uint32_t imiss = hal_hpm3_read();
+#endif
+
+  if (event_handle >= count_) return;
+
+  Entry& entry = entries_[event_handle];
+  entry.calls++;
+  entry.cycles += t1 - entry.start;
+#ifdef CFG_PROFILER_IMISS
+  entry.imiss += imiss - entry.imiss_start;
+#endif
+}
+
+void CycleProfiler::Dump() const {
+  for (uint32_t i = 0; i < count_; i++) {
+#ifdef CFG_PROFILER_IMISS
+    printf("profile,%s,%s,%u,%u,%u\n", name_, entries_[i].tag,
+           (unsigned) entries_[i].calls, (unsigned) entries_[i].cycles,
+           (unsigned) entries_[i].imiss);
+#else
+    printf("profile,%s,%s,%u,%u\n", name_, entries_[i].tag,
+           (unsigned) entries_[i].calls, (unsigned) entries_[i].cycles);
+#endif
+  }
+}
+
+void CycleProfiler::Reset() {
+  for (uint32_t i = 0; i < count_; i++) {
+    entries_[i].calls = 0;
+    entries_[i].cycles = 0;
+#ifdef CFG_PROFILER_IMISS
+    entries_[i].imiss = 0;
+#endif
+  }
+}
@@ -20,6 +20,8 @@
 #include <stdint.h>
 
 #include "adam_ral.h"
+#include "cfg.h"
+#include "console.h"
 
 void* __dso_handle = (void*) &__dso_handle;
 
@@ -55,12 +57,16 @@ extern "C" int _write(int file, char* buf, int nbytes) {
     return (nbytes < 0) ? 0 : -1;
   }
 
+#ifdef CFG_STDOUT_IRQ
+  return console_write(buf, nbytes);
+#else
   for (int i = 0; i < nbytes; i++) {
       while(!RAL.LSPA.UART[0]->TBE);
       RAL.LSPA.UART[0]->DR = *buf++;
   }
 
   return nbytes;
+#endif
 }
 
 extern "C" int _close(int file) {
@@ -97,6 +103,9 @@ extern "C" int _isatty(int file) {
   return 1;
 }
 
+// With CFG_ALLOCATOR, new and delete come from the pools of alloc.cpp. The
+// sbrk heap above is then left to newlib.
+#ifndef CFG_ALLOCATOR
 void operator delete(void* p) noexcept {
   free(p);
 }
@@ -104,3 +113,4 @@ void operator delete(void* p) noexcept {
 extern "C" void operator delete(void* p, unsigned long) noexcept {
   operator delete(p);
 }
+#endif
@@ -0,0 +1,62 @@
+#include "vad.h"
+
+#ifdef CFG_VAD
+
+// Energies are sums of s^2 >> 9 over a frame, which keeps a full-scale
+// 20 ms frame within 31 bits
+#define VAD_ENERGY_SHIFT 9
+
+_Static_assert((uint64_t) CFG_AUDIO_STRIDE_COUNT * (32768 * 32768
+    >> VAD_ENERGY_SHIFT) < (1u << 31), "VAD frame energy overflows");
+
+static void LPMEM_TEXT vad_frame(vad_t *vad)
+{
+    uint32_t energy = vad->energy;
+    uint32_t floor = vad->floor;
+
+    if (floor < CFG_VAD_FLOOR_MIN) floor = CFG_VAD_FLOOR_MIN;
+
+    int speech = vad->frames >= CFG_VAD_TRAIN
+        && (energy >> CFG_VAD_SNR_SHIFT) > floor
+        && vad->crossings >= CFG_VAD_ZCR_MIN
+        && vad->crossings <= CFG_VAD_ZCR_MAX;
+
+    // The floor follows quiet frames down quickly and creeps up, slower
+    // still during speech so a word does not become the new floor while a
+    // lasting noise eventually does. It converges fast while training.
+    int32_t diff = (int32_t) (energy - vad->floor);
+    int shift;
+    if (diff < 0 || vad->frames < CFG_VAD_TRAIN)
+        shift = 1;
+    else if (speech)
+        shift = CFG_VAD_SPEECH_RISE_SHIFT;
+    else
+        shift = CFG_VAD_RISE_SHIFT;
+    vad->floor += diff >> shift;
+
+    if (vad->frames < CFG_VAD_TRAIN) vad->frames++;
+
+    if (!speech) {
+        vad->onset = 0;
+        if (vad->hangover) vad->hangover--;
+    } else if (vad->hangover || ++vad->onset >= CFG_VAD_ONSET) {
+        vad->hangover = CFG_VAD_HANGOVER;
+    }
+
+    vad->energy = 0;
+    vad->crossings = 0;
+    vad->count = 0;
+}
+
+int LPMEM_TEXT vad_push(vad_t *vad, int16_t sample)
+{
+    vad->energy += (uint32_t) ((int32_t) sample * sample) >> VAD_ENERGY_SHIFT;
+    vad->crossings += (sample ^ vad->prev) < 0;
+    vad->prev = sample;
+
+    if (++vad->count == CFG_AUDIO_STRIDE_COUNT) vad_frame(vad);
+
+    return vad_active(vad);
+}
+
+#endif